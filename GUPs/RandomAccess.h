@@ -1,6 +1,10 @@
 /* -*- mode: C; tab-width: 2; indent-tabs-mode: nil; -*- */
 #include<time.h>
 #include<sys/time.h>
+#include<stdio.h>
+#include<stdlib.h>
+#include<math.h>
+#include "cycles.h"
 
 /* Random number generator */
 #ifdef LONG_IS_64BITS
@@ -22,6 +26,23 @@ static double RTSEC()
 
 extern s64Int starts (u64Int);
 
+/*
+ * Batched stream generator: RA_STREAM_LANES interleaved copies of the
+ * stream advanced together in SIMD lanes where the target has them.
+ * RA_StreamFill() returns the same elements, in the same order, as the
+ * scalar ran = (ran << 1) ^ ... loop started from starts(n).
+ */
+#define RA_STREAM_LANES 8
+#define RA_STREAM_BLOCK 1024  /* elements generated ahead of an update loop */
+typedef struct {
+  u64Int lane[RA_STREAM_LANES];   /* next element of each lane */
+  u64Int spare[RA_STREAM_LANES];  /* row split by the last fill */
+  int nspare;                     /* elements of spare[] not handed out */
+} RA_Stream_t;
+
+extern void RA_StreamInit(RA_Stream_t *s, u64Int n);
+extern void RA_StreamFill(RA_Stream_t *s, u64Int *buf, s64Int count);
+
 #define WANT_MPI2_TEST 0
 
 
@@ -33,6 +54,15 @@ extern s64Int starts (u64Int);
 #define UPDATE_TAG   2
 #define USE_NONBLOCKING_SEND 1
 
+/* Table sizing defaults (see -n, -f and -u) */
+#define RA_DEFAULT_PE_MEM 20000000
+#define RA_DEFAULT_UPDATES_PER_ENTRY 4
+
+/* Time-bounded runs (-t): each mode is first timed on 1/RA_TIME_BOUND_SAMPLE
+ * of its updates; building with -DRA_TIME_BOUND makes the bound the default */
+#define RA_DEFAULT_TIME_BOUND 60.0
+#define RA_TIME_BOUND_SAMPLE 100
+
 #define MAX_TOTAL_PENDING_UPDATES 1024
 #define LOCAL_BUFFER_SIZE MAX_TOTAL_PENDING_UPDATES
 
@@ -62,3 +92,334 @@ Power2NodesRandomAccessUpdate(u64Int logTableSize,
                                  int MyProc,
                                  s64Int ProcNumUpdates);
 
+/* Update engines (selected with -m) */
+#define RA_MODE_GETPUT   0   /* blocking get/xor/put + quiet per update */
+#define RA_MODE_BUCKET   1   /* look-ahead buckets, one bulk put per owner */
+#define RA_MODE_AMO      2   /* one remote shmem_atomic_xor per update */
+#define RA_MODE_NBI      3   /* RA_Window get_nbi in flight, one quiet per window */
+#define RA_MODE_PTR      4   /* shmem_ptr load/store on-node, shmem_atomic_xor off-node */
+#define RA_MODE_ROUTE    5   /* buckets per node, scattered on-node by a partner PE */
+#define RA_MODE_LOCAL    6   /* own slice only, plain loads/stores (SingleRandomAccess) */
+#define RA_MODE_PREFETCH 7   /* local, with RA_Prefetch addresses prefetched ahead */
+#define RA_MODE_FETCHNBI 8   /* RA_Window fetch_xor_nbi in flight, one quiet per window */
+#define RA_MODE_SIGNAL   9   /* buckets by put-with-signal, applied as they arrive */
+#define RA_NUM_MODES     10
+
+/* OpenSHMEM interfaces of spec version maj.min and later (use after shmem.h) */
+#define RA_SHMEM_AT_LEAST(maj, min) \
+  (SHMEM_MAJOR_VERSION > (maj) || \
+   (SHMEM_MAJOR_VERSION == (maj) && SHMEM_MINOR_VERSION >= (min)))
+
+typedef double (*RandomAccessUpdate_t)(u64Int logTableSize,
+                                       u64Int TableSize,
+                                       u64Int LocalTableSize,
+                                       u64Int MinLocalTableSize,
+                                       u64Int GlobalStartMyProc,
+                                       u64Int Top,
+                                       int logNumProcs,
+                                       int NumProcs,
+                                       int Remainder,
+                                       int MyProc,
+                                       s64Int ProcNumUpdates);
+
+extern double
+GetPutRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates);
+
+extern double
+BucketRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates);
+
+extern double
+AMORandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates);
+
+extern double
+NBIRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates);
+
+extern double
+PtrRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates);
+
+extern double
+RouteRandomAccessUpdate(u64Int logTableSize,
+                        u64Int TableSize,
+                        u64Int LocalTableSize,
+                        u64Int MinLocalTableSize,
+                        u64Int GlobalStartMyProc,
+                        u64Int Top,
+                        int logNumProcs,
+                        int NumProcs,
+                        int Remainder,
+                        int MyProc,
+                        s64Int ProcNumUpdates);
+
+/* Consecutive PEs sharing a node, for the route engine (see main) */
+extern int RA_PesPerNode;
+
+/* Split of the ptr engine's updates and time into on-node and off-node */
+#define RA_ON_NODE  0
+#define RA_OFF_NODE 1
+extern s64Int RA_NodeUpdates[2];
+extern double RA_NodeTime[2];
+extern u64Int **RA_PeTable;
+
+/* Local pass: every PE updates only its own slice, no SHMEM calls */
+extern double
+LocalRandomAccessUpdate(u64Int logTableSize,
+                        u64Int TableSize,
+                        u64Int LocalTableSize,
+                        u64Int MinLocalTableSize,
+                        u64Int GlobalStartMyProc,
+                        u64Int Top,
+                        int logNumProcs,
+                        int NumProcs,
+                        int Remainder,
+                        int MyProc,
+                        s64Int ProcNumUpdates);
+
+/* Buckets delivered with put-with-signal and no barrier */
+extern double
+SignalRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates);
+
+/* Fetching AMOs in windows; the fetched old values are folded into
+ * RA_Checksum (XOR), which depends on the order the updates land in */
+extern double
+FetchNBIRandomAccessUpdate(u64Int logTableSize,
+                           u64Int TableSize,
+                           u64Int LocalTableSize,
+                           u64Int MinLocalTableSize,
+                           u64Int GlobalStartMyProc,
+                           u64Int Top,
+                           int logNumProcs,
+                           int NumProcs,
+                           int Remainder,
+                           int MyProc,
+                           s64Int ProcNumUpdates);
+
+extern u64Int RA_Checksum;
+
+/* Local pass with software prefetch RA_Prefetch updates ahead (-k) */
+extern double
+PrefetchRandomAccessUpdate(u64Int logTableSize,
+                           u64Int TableSize,
+                           u64Int LocalTableSize,
+                           u64Int MinLocalTableSize,
+                           u64Int GlobalStartMyProc,
+                           u64Int Top,
+                           int logNumProcs,
+                           int NumProcs,
+                           int Remainder,
+                           int MyProc,
+                           s64Int ProcNumUpdates);
+
+#define RA_DEFAULT_PREFETCH 16
+extern int RA_Prefetch;
+
+/* Updates in flight per window for the nbi engine (-w) */
+#define RA_DEFAULT_WINDOW 64
+extern int RA_Window;
+
+/*
+ * Sampled update latency (-l): the getput and amo engines time every
+ * RA_LatSample-th update with get_cycles() into RA_LatHist, which has four
+ * log-spaced buckets per power of two (values below 4 get their own).
+ */
+#define RA_LAT_BUCKETS 256
+extern int RA_LatSample;
+extern long long RA_LatHist[RA_LAT_BUCKETS];
+extern long long RA_LatMax;
+
+static inline void
+RA_LatRecord(cycles_t c)
+{
+  int b = 63 - __builtin_clzll((unsigned long long) c | 1);
+
+  RA_LatHist[b < 2 ? (int) c : 4*b + (int) ((c >> (b-2)) & 3)]++;
+  if ((long long) c > RA_LatMax)
+    RA_LatMax = c;
+}
+
+/* Largest value (in cycles) counted in bucket i of RA_LatHist */
+static inline double
+RA_LatBucketTop(int i)
+{
+  return i < 4 ? i : ldexp(4 + (i & 3) + 1, i/4 - 2) - 1;
+}
+
+/* Error check of the local modes: the stream is replayed on the PE's own
+ * slice only, so no other PE takes part */
+extern s64Int
+LocalRandomAccessCheck(u64Int logTableSize,
+                       u64Int TableSize,
+                       u64Int LocalTableSize,
+                       u64Int MinLocalTableSize,
+                       u64Int GlobalStartMyProc,
+                       u64Int Top,
+                       int logNumProcs,
+                       int NumProcs,
+                       int Remainder,
+                       int MyProc,
+                       s64Int ProcNumUpdates);
+
+/* Error check: returns the number of local table words that differ from
+ * their initial value after the update stream has been applied twice */
+extern s64Int
+RandomAccessCheck(u64Int logTableSize,
+                  u64Int TableSize,
+                  u64Int LocalTableSize,
+                  u64Int MinLocalTableSize,
+                  u64Int GlobalStartMyProc,
+                  u64Int Top,
+                  int logNumProcs,
+                  int NumProcs,
+                  int Remainder,
+                  int MyProc,
+                  s64Int ProcNumUpdates);
+
+/*
+ * Address distributions (-d).  The stream values stay the XOR data; only
+ * the word a value addresses is drawn from the distribution instead of
+ * its low bits.  This happens in RA_Owner, so every remote engine and the
+ * check agree on the addresses.  The local modes are not affected.
+ */
+#define RA_DIST_UNIFORM 0
+#define RA_DIST_ZIPF    1   /* word ranks Zipf(RA_ZipfS), scattered over the table */
+#define RA_DIST_HOT     2   /* RA_HotFraction of the updates to PE RA_HotPE */
+extern int RA_Dist;
+extern double RA_ZipfS;
+extern double RA_HotFraction;
+extern int RA_HotPE;
+
+extern u64Int RA_SkewIndex(u64Int ran, u64Int TableSize, u64Int MinLocalTableSize,
+                           int Remainder);
+
+/* Updates this PE's stream sends to each PE, from a replay of the stream */
+extern void
+RandomAccessTargets(s64Int *counts,
+                    u64Int logTableSize,
+                    u64Int TableSize,
+                    u64Int LocalTableSize,
+                    u64Int MinLocalTableSize,
+                    u64Int GlobalStartMyProc,
+                    u64Int Top,
+                    int logNumProcs,
+                    int NumProcs,
+                    int Remainder,
+                    int MyProc,
+                    s64Int ProcNumUpdates);
+
+/* Words held by pe: the first Remainder PEs hold one extra word */
+static inline u64Int
+RA_LocalSize(int pe, u64Int MinLocalTableSize, int Remainder)
+{
+  return pe < Remainder ? MinLocalTableSize + 1 : MinLocalTableSize;
+}
+
+/*
+ * Owner and local offset of the word addressed by ran in the HPCC block
+ * distribution: the Top words of the table live on the first Remainder
+ * PEs (MinLocalTableSize + 1 words each), the rest on the other PEs
+ * (MinLocalTableSize words each).  With a power-of-two PE count Remainder
+ * is 0 and this reduces to a shift and a mask.
+ */
+static inline int
+RA_Owner(u64Int ran, int logTableLocal, u64Int TableSize,
+         u64Int MinLocalTableSize, u64Int Top, int Remainder, u64Int *offset)
+{
+  u64Int GlobalOffset = RA_Dist == RA_DIST_UNIFORM ? ran & (TableSize - 1) :
+                        RA_SkewIndex(ran, TableSize, MinLocalTableSize, Remainder);
+  int pe;
+
+  if (Remainder == 0) {
+    *offset = GlobalOffset & (MinLocalTableSize - 1);
+    return GlobalOffset >> logTableLocal;
+  }
+  if (GlobalOffset < Top) {
+    pe = GlobalOffset / (MinLocalTableSize + 1);
+    *offset = GlobalOffset - pe * (MinLocalTableSize + 1);
+  }
+  else {
+    pe = (GlobalOffset - Remainder) / MinLocalTableSize;
+    *offset = GlobalOffset - (pe * MinLocalTableSize + Remainder);
+  }
+  return pe;
+}
+
+/*
+ * Target of an update: the owner of the word, except that updates this PE
+ * would make to itself go to the next PE instead, so that all updates are
+ * remote.  The offset wraps if that PE holds one word less.
+ */
+static inline int
+RA_Target(u64Int ran, int logTableLocal, u64Int TableSize,
+          u64Int MinLocalTableSize, u64Int Top, int Remainder,
+          int NumProcs, int MyProc, u64Int *offset)
+{
+  int pe = RA_Owner(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                    Remainder, offset);
+
+  if (pe == MyProc && NumProcs > 1) {
+    pe = (pe + 1) % NumProcs;
+    if (*offset >= RA_LocalSize(pe, MinLocalTableSize, Remainder))
+      *offset -= RA_LocalSize(pe, MinLocalTableSize, Remainder);
+  }
+  return pe;
+}
+
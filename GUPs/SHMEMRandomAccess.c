@@ -34,13 +34,20 @@
  *
  */
 
+#define _GNU_SOURCE
 #include <sched.h>
 #include <hpcc.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "RandomAccess.h"
 #include <shmem.h>
 #define MAXTHREADS 256
 
+/* Transparent huge page size the table is advised for with -p */
+#define RA_THP_PAGE ((size_t) 2 << 20)
+
 void
 do_abort(char* f)
 {
@@ -55,6 +62,550 @@ u64Int targetBuf[sizeof(srcBuf) / sizeof(u64Int)];
 /* Allocate main table (in global memory) */
 u64Int *HPCC_Table;
 
+static const char *ModeName[RA_NUM_MODES] = {
+  "getput",
+  "bucket",
+  "amo",
+  "nbi",
+  "ptr",
+  "route",
+  "local",
+  "prefetch",
+  "fetchnbi",
+  "signal"
+};
+
+static RandomAccessUpdate_t UpdateEngine[RA_NUM_MODES] = {
+  GetPutRandomAccessUpdate,
+  BucketRandomAccessUpdate,
+  AMORandomAccessUpdate,
+  NBIRandomAccessUpdate,
+  PtrRandomAccessUpdate,
+  RouteRandomAccessUpdate,
+  LocalRandomAccessUpdate,
+  PrefetchRandomAccessUpdate,
+  FetchNBIRandomAccessUpdate,
+  SignalRandomAccessUpdate
+};
+
+/* Node size for the route engine, counted once the table exists */
+int RA_PesPerNode = 1;
+
+/* Sampled update latency (-l); global, hence symmetric for the reductions */
+int RA_LatSample = 0;
+long long RA_LatHist[RA_LAT_BUCKETS];
+long long RA_LatMax;
+static long long GlbLatHist[RA_LAT_BUCKETS];
+static long long GlbLatMax;
+static long long LatWrk[RA_LAT_BUCKETS/2 + 1 + _SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+static long LatSync[_SHMEM_REDUCE_SYNC_SIZE];
+
+/* Address distribution of the remote modes (-d) */
+int RA_Dist = RA_DIST_UNIFORM;
+double RA_ZipfS = 1.0;
+double RA_HotFraction = 0.5;
+int RA_HotPE = 0;
+static long DistSync[_SHMEM_REDUCE_SYNC_SIZE];
+
+/* XOR of the old values fetched by the fetchnbi engine (symmetric) */
+u64Int RA_Checksum;
+static u64Int GlbChecksum;
+
+/* On-node/off-node split of the ptr engine (symmetric for the reduction) */
+s64Int RA_NodeUpdates[2];
+double RA_NodeTime[2];
+static s64Int GlbNodeUpdates[2];
+
+/* shmem_ptr() of every PE's slice for the ptr engine, NULL where it can't map */
+u64Int **RA_PeTable;
+
+/* Window depths to run the nbi engine with (-w) */
+#define RA_MAX_WINDOWS 16
+int RA_Window = RA_DEFAULT_WINDOW;
+static int Windows[RA_MAX_WINDOWS] = { RA_DEFAULT_WINDOW };
+static int NumWindows = 1;
+
+/* Prefetch distances to run the prefetch engine with (-k) */
+int RA_Prefetch = RA_DEFAULT_PREFETCH;
+static int Prefetches[RA_MAX_WINDOWS] = { RA_DEFAULT_PREFETCH };
+static int NumPrefetches = 1;
+
+/* One row of the summary table per timed run */
+#define RA_MAX_RUNS (RA_NUM_MODES + 3 * RA_MAX_WINDOWS)
+typedef struct {
+  char name[32];
+  double time;
+  double updates;           /* performed, fewer than NumUpdates if time bound */
+  s64Int errors;
+} RA_Run_t;
+
+static void
+usage(char *prog)
+{
+  int mode;
+
+  fprintf(stderr, "Usage: %s [-m mode[,mode...]] [-w depth[,depth...]|sweep] [-k dist[,dist...]|sweep]\n"
+                  "          [-n log2_words_per_PE | -f mem_fraction] [-u updates_per_entry] [-t seconds] [-l N]\n"
+                  "          [-p page_size] [-d dist] [-s] [-v] [-h]\n", prog);
+  fprintf(stderr, "  -m  update modes to run, or 'all' (default: getput)\n");
+  fprintf(stderr, "      available:");
+  for (mode = 0; mode < RA_NUM_MODES; mode++)
+    fprintf(stderr, " %s", ModeName[mode]);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -w  updates in flight for the nbi and fetchnbi modes, 1..%d, or 'sweep'\n"
+                  "      for all powers of two (default: %d)\n",
+          MAX_TOTAL_PENDING_UPDATES, RA_DEFAULT_WINDOW);
+  fprintf(stderr, "  -k  updates the prefetch mode prefetches ahead, 1..%d, or 'sweep'\n"
+                  "      for all powers of two (default: %d)\n",
+          RA_STREAM_BLOCK, RA_DEFAULT_PREFETCH);
+  fprintf(stderr, "  -n  table size as log2 of the words per PE (env GUPS_LOG_LOCAL_SIZE)\n");
+  fprintf(stderr, "  -f  table size as a fraction of the node's physical memory,\n"
+                  "      shared by the PEs on the node (env GUPS_MEM_FRACTION)\n");
+  fprintf(stderr, "      default without -n/-f: %d bytes per PE\n", RA_DEFAULT_PE_MEM);
+  fprintf(stderr, "  -u  updates per table entry (env GUPS_UPDATES_PER_ENTRY, default %d)\n",
+          RA_DEFAULT_UPDATES_PER_ENTRY);
+  fprintf(stderr, "  -t  time bound in seconds per mode: a short calibration run sets\n"
+                  "      the update count (env GUPS_TIME_BOUND, 0 for none)\n");
+  fprintf(stderr, "  -l  time every N-th update of the getput and amo modes and print\n"
+                  "      latency percentiles per PE and overall (env GUPS_LAT_SAMPLE)\n");
+  fprintf(stderr, "  -p  back the table with pages of this size, e.g. 2m (transparent\n"
+                  "      huge pages) or 1g (hugetlbfs symmetric heap); 0 for a plain\n"
+                  "      shmem_malloc (env GUPS_PAGE_SIZE, default 0)\n");
+  fprintf(stderr, "  -d  address distribution of the remote modes: uniform, zipf[:s]\n"
+                  "      (exponent s, default 1) or hot[:fraction[:pe]] (that fraction\n"
+                  "      of the updates to one PE, default 0.5 to PE 0); prints the\n"
+                  "      updates each PE received (env GUPS_DIST)\n");
+  fprintf(stderr, "  -s  sweep the table size in powers of two from L1-sized up to the\n"
+                  "      size given by -n/-f, one GUP/s row per size\n");
+  fprintf(stderr, "  -v  count table errors after each mode (HPCC check)\n");
+}
+
+/* Physical memory of this node in bytes, 0 if it cannot be determined */
+static double
+node_memory(void)
+{
+  FILE *f;
+  char line[256];
+  double kb = 0;
+
+  if ((f = fopen("/proc/meminfo", "r")) != NULL) {
+    while (fgets(line, sizeof(line), f))
+      if (sscanf(line, "MemTotal: %lf kB", &kb) == 1)
+        break;
+    fclose(f);
+  }
+  if (kb > 0)
+    return kb * 1024;
+
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  return (double) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+/*
+ * Number of PEs sharing this node: those whose copy of the symmetric
+ * object sym is directly addressable.  GUPS_PES_PER_NODE overrides this
+ * for libraries whose shmem_ptr() only ever returns the local address.
+ */
+static int
+node_pes(void *sym, int NumProcs)
+{
+  int pe, n = 0;
+  char *env;
+
+  if ((env = getenv("GUPS_PES_PER_NODE")) != NULL && atoi(env) > 0)
+    return atoi(env);
+
+  for (pe = 0; pe < NumProcs; pe++)
+    if (shmem_ptr(sym, pe) != NULL)
+      n++;
+  return n > 0 ? n : 1;
+}
+
+/* Page size argument of -p: bytes with an optional k, m or g suffix */
+static size_t
+parse_size(const char *arg)
+{
+  char *end;
+  double v = strtod(arg, &end);
+
+  switch (*end) {
+  case 'g': case 'G': v *= 1024;  /* FALLTHROUGH */
+  case 'm': case 'M': v *= 1024;  /* FALLTHROUGH */
+  case 'k': case 'K': v *= 1024;
+  }
+  return v > 0 ? (size_t) v : 0;
+}
+
+/*
+ * Symmetric allocation of the main table.  With a page size the table is
+ * aligned to it and padded to a whole number of pages (same size on every
+ * PE), advised for transparent huge pages when the page is the THP size,
+ * and pre-faulted so that the pages are in place before any timing.
+ * Pages larger than THP (1 GiB) need a symmetric heap the library already
+ * backs with hugetlbfs; the alignment then keeps the table in few of them.
+ */
+static u64Int *
+table_alloc(size_t bytes, size_t page, int MyProc, FILE *outFile)
+{
+  u64Int *t;
+
+  if (page == 0)
+    return (u64Int *)shmem_malloc(bytes);
+
+  bytes = (bytes + page - 1) / page * page;
+  t = (u64Int *)shmem_align(page, bytes);
+  if (! t)
+    return NULL;
+
+#ifdef MADV_HUGEPAGE
+  if (page == RA_THP_PAGE && madvise(t, bytes, MADV_HUGEPAGE) != 0 && MyProc == 0)
+    fprintf(outFile, "madvise(MADV_HUGEPAGE) failed on the table, continuing\n");
+#endif
+  memset(t, 0, bytes);
+  return t;
+}
+
+/*
+ * Page size backing the table at t, from the smaps entry of the mapping
+ * that holds it: the kernel page size (hugetlbfs) and how much of that
+ * mapping is in transparent huge pages.  Returns 0 if smaps is unreadable.
+ */
+static long
+table_page_kb(void *t, long *thp_kb, long *vma_kb)
+{
+  FILE *f;
+  char line[256];
+  unsigned long lo, hi, addr = (unsigned long) t;
+  long kb, page_kb = 0;
+  int inside = 0;
+
+  *thp_kb = *vma_kb = 0;
+  if ((f = fopen("/proc/self/smaps", "r")) == NULL)
+    return 0;
+  while (fgets(line, sizeof(line), f)) {
+    if (sscanf(line, "%lx-%lx ", &lo, &hi) == 2) {
+      if (inside)
+        break;
+      inside = (addr >= lo && addr < hi);
+    }
+    else if (! inside)
+      continue;
+    else if (sscanf(line, "Size: %ld kB", &kb) == 1)
+      *vma_kb = kb;
+    else if (sscanf(line, "KernelPageSize: %ld kB", &kb) == 1)
+      page_kb = kb;
+    else if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1 ||
+             sscanf(line, "ShmemPmdMapped: %ld kB", &kb) == 1)
+      *thp_kb += kb;
+  }
+  fclose(f);
+  return page_kb;
+}
+
+/* Cycles at or below which a fraction p of the samples in hist fall */
+static double
+lat_percentile(long long *hist, double p)
+{
+  long long total = 0, sum = 0;
+  int i;
+
+  for (i = 0; i < RA_LAT_BUCKETS; i++)
+    total += hist[i];
+  for (i = 0; i < RA_LAT_BUCKETS; i++)
+    if ((sum += hist[i]) >= p * total && sum > 0)
+      return RA_LatBucketTop(i);
+  return 0;
+}
+
+/*
+ * Tail-latency report for the last run: every PE reduces its percentiles
+ * from its own histogram and puts them on PE 0; the histograms are summed
+ * for the global line.  Percentiles are bucket upper bounds, within 25%.
+ */
+static void
+lat_report(FILE *outFile, int NumProcs, int MyProc, double mhz)
+{
+  static const double pct[] = { 0.5, 0.9, 0.99, 0.999 };
+  const int nstat = sizeof(pct)/sizeof(pct[0]) + 2;   /* + max, samples */
+  double *PeStat, mine[sizeof(pct)/sizeof(pct[0]) + 2];
+  long long n = 0;
+  int i, pe;
+
+  for (i = 0; i < RA_LAT_BUCKETS; i++)
+    n += RA_LatHist[i];
+  for (i = 0; i < nstat - 2; i++)
+    mine[i] = lat_percentile(RA_LatHist, pct[i]) / mhz;
+  mine[nstat-2] = RA_LatMax / mhz;
+  mine[nstat-1] = n;
+
+  PeStat = (double *)shmem_malloc(sizeof(double) * nstat * NumProcs);
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i++)
+    LatSync[i] = _SHMEM_SYNC_VALUE;
+  shmem_barrier_all();
+  shmem_double_put(&PeStat[MyProc * nstat], mine, nstat, 0);
+  shmem_longlong_sum_to_all(GlbLatHist, RA_LatHist, RA_LAT_BUCKETS, 0,0, NumProcs, LatWrk, LatSync);
+  shmem_barrier_all();
+  shmem_longlong_max_to_all(&GlbLatMax, &RA_LatMax, 1, 0,0, NumProcs, LatWrk, LatSync);
+
+  if (MyProc == 0) {
+    fprintf( outFile, "Update latency, usec (every %d-th update sampled)\n", RA_LatSample );
+    fprintf( outFile, "%8s %10s %10s %10s %10s %10s %10s\n", "PE", "samples",
+             "p50", "p90", "p99", "p99.9", "max" );
+    for (pe = 0; pe < NumProcs; pe++) {
+      fprintf( outFile, "%8d %10.0f", pe, PeStat[pe*nstat + nstat-1] );
+      for (i = 0; i < nstat - 1; i++)
+        fprintf( outFile, " %10.3f", PeStat[pe*nstat + i] );
+      fprintf( outFile, "\n" );
+    }
+    for (i = 0, n = 0; i < RA_LAT_BUCKETS; i++)
+      n += GlbLatHist[i];
+    fprintf( outFile, "%8s %10lld", "all", n );
+    for (i = 0; i < nstat - 2; i++)
+      fprintf( outFile, " %10.3f", lat_percentile(GlbLatHist, pct[i]) / mhz );
+    fprintf( outFile, " %10.3f\n", GlbLatMax / mhz );
+  }
+
+  shmem_barrier_all();
+  shmem_free(PeStat);
+}
+
+/* Parse -d: uniform, zipf[:s] or hot[:fraction[:pe]]; -1 if invalid */
+static int
+parse_dist(char *arg)
+{
+  char *tok = strtok(arg, ":");
+
+  if (! tok)
+    return -1;
+  if (0 == strcmp(tok, "uniform"))
+    return RA_DIST_UNIFORM;
+  if (0 == strcmp(tok, "zipf")) {
+    if ((tok = strtok(NULL, ":")) != NULL)
+      RA_ZipfS = atof(tok);
+    return RA_ZipfS > 0 ? RA_DIST_ZIPF : -1;
+  }
+  if (0 == strcmp(tok, "hot")) {
+    if ((tok = strtok(NULL, ":")) != NULL)
+      RA_HotFraction = atof(tok);
+    if ((tok = strtok(NULL, ":")) != NULL)
+      RA_HotPE = atoi(tok);
+    return RA_HotFraction >= 0 && RA_HotFraction <= 1 && RA_HotPE >= 0 ? RA_DIST_HOT : -1;
+  }
+  return -1;
+}
+
+/*
+ * Updates every PE received in the last run, next to its GUP/s: each PE
+ * replays its stream to count what it sent where, and the counts are
+ * summed over the PEs.
+ */
+static void
+dist_report(FILE *outFile, u64Int logTableSize, u64Int TableSize,
+            u64Int LocalTableSize, u64Int MinLocalTableSize,
+            u64Int GlobalStartMyProc, u64Int Top, int logNumProcs,
+            int NumProcs, int Remainder, int MyProc, s64Int ProcNumUpdates)
+{
+  s64Int *Sent, *Received, min, max;
+  long long *Wrk;
+  double avg;
+  int i, hot = 0;
+
+  Sent = (s64Int *)shmem_malloc(sizeof(s64Int) * NumProcs);
+  Received = (s64Int *)shmem_malloc(sizeof(s64Int) * NumProcs);
+  Wrk = (long long *)shmem_malloc(sizeof(long long) * (NumProcs/2 + 1 + _SHMEM_REDUCE_MIN_WRKDATA_SIZE));
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i++)
+    DistSync[i] = _SHMEM_SYNC_VALUE;
+
+  RandomAccessTargets(Sent, logTableSize, TableSize, LocalTableSize, MinLocalTableSize,
+                      GlobalStartMyProc, Top, logNumProcs, NumProcs, Remainder, MyProc,
+                      ProcNumUpdates);
+  shmem_barrier_all();
+  shmem_longlong_sum_to_all((long long *)Received, (long long *)Sent, NumProcs,
+                            0,0, NumProcs, Wrk, DistSync);
+
+  if (MyProc == 0) {
+    min = max = Received[0];
+    for (i = 0, avg = 0; i < NumProcs; i++) {
+      avg += (double) Received[i] / NumProcs;
+      if (Received[i] < min)
+        min = Received[i];
+      if (Received[i] > max) {
+        max = Received[i];
+        hot = i;
+      }
+    }
+    fprintf( outFile, "Received updates/PE: min %lld, avg %.0f, max %lld on PE %d (%.2f x avg)\n",
+             (long long) min, avg, (long long) max, hot, avg > 0 ? max / avg : 0.0 );
+    /* Every PE's count for jobs small enough to read them */
+    if (NumProcs <= 64)
+      for (i = 0; i < NumProcs; i++)
+        fprintf( outFile, "%8d %12lld%s", i, (long long) Received[i],
+                 (i % 4 == 3 || i == NumProcs - 1) ? "\n" : "" );
+  }
+
+  shmem_barrier_all();
+  shmem_free(Wrk);
+  shmem_free(Received);
+  shmem_free(Sent);
+}
+
+/*
+ * Block distribution of a 2^logTableSize word table over NumProcs PEs.
+ * As in HPCC, when NumProcs does not divide the table the first Remainder
+ * PEs hold one extra word, and Top is the first global index past them.
+ */
+static void
+table_layout(u64Int logTableSize, int NumProcs, int MyProc,
+             u64Int *TableSize, u64Int *MinLocalTableSize,
+             s64Int *LocalTableSize, u64Int *GlobalStartMyProc,
+             int *Remainder, u64Int *Top)
+{
+  *TableSize = (u64Int) 1 << logTableSize;
+  *MinLocalTableSize = (*TableSize / NumProcs);
+  *Remainder = *TableSize - *MinLocalTableSize * NumProcs;
+  *Top = (*MinLocalTableSize + 1) * *Remainder;
+  *LocalTableSize = RA_LocalSize(MyProc, *MinLocalTableSize, *Remainder);
+  if (MyProc < *Remainder)
+    *GlobalStartMyProc = (*MinLocalTableSize + 1) * MyProc;
+  else
+    *GlobalStartMyProc = *MinLocalTableSize * MyProc + *Remainder;
+}
+
+/* Smallest table to sweep from: the L1 data cache of one core */
+static u64Int
+l1_words(void)
+{
+  long bytes = 0;
+
+#ifdef _SC_LEVEL1_DCACHE_SIZE
+  bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE);
+#endif
+  if (bytes <= 0)
+    bytes = 32768;
+  return bytes / sizeof(u64Int);
+}
+
+/*
+ * Table-size sweep: rerun the local pass and every selected update mode
+ * for global tables of 2^log words, from about one L1 cache per PE up to
+ * logTableSizeMax, all inside the one HPCC_Table allocation.  The local
+ * pass, and the prefetch mode when it is selected, only touch the PE's own
+ * slice (cache/DRAM) and come first; the other update modes only remote
+ * slices (network), so each row shows both sides of the curve.
+ */
+static void
+size_sweep(FILE *outFile, int ModeMask, u64Int logTableSizeMax,
+           int logNumProcs, int NumProcs, int MyProc, int UpdatesPerEntry)
+{
+  u64Int logT, logMin, TableSize, MinLocalTableSize, GlobalStartMyProc, Top;
+  s64Int LocalTableSize, ProcNumUpdates, i;
+  int Remainder, mode, prefetch, column[RA_NUM_MODES], ncolumn, c;
+  double RealTime, NumUpdates;
+
+  for (logMin = 0; ((u64Int) 1 << logMin) < l1_words(); logMin++)
+    ; /* EMPTY */
+  logMin += logNumProcs;
+  if (logMin > logTableSizeMax)
+    logMin = logTableSizeMax;
+
+  RA_Window = Windows[0];
+  RA_Prefetch = Prefetches[0];
+  ModeMask &= ~(1 << RA_MODE_LOCAL);  /* always the first column */
+  prefetch = (ModeMask >> RA_MODE_PREFETCH) & 1;  /* local too: next to it */
+  ncolumn = 0;
+  if (prefetch)
+    column[ncolumn++] = RA_MODE_PREFETCH;
+  for (mode = 0; mode < RA_NUM_MODES; mode++)
+    if (mode != RA_MODE_PREFETCH && (ModeMask & (1 << mode)))
+      column[ncolumn++] = mode;
+
+  if (MyProc == 0) {
+    fprintf( outFile, "\nTable-size sweep, %d updates per entry, GUP/s\n", UpdatesPerEntry );
+    fprintf( outFile, "(local%s: updates to the PE's own slice only; other modes: remote updates only)\n",
+             prefetch ? ", prefetch" : "" );
+    fprintf( outFile, "%8s %14s %14s", "log2(T)", "bytes/PE", "local" );
+    for (c = 0; c < ncolumn; c++)
+      fprintf( outFile, " %14s", ModeName[column[c]] );
+    fprintf( outFile, "\n" );
+  }
+
+  for (logT = logMin; logT <= logTableSizeMax; logT++) {
+    table_layout(logT, NumProcs, MyProc, &TableSize, &MinLocalTableSize,
+                 &LocalTableSize, &GlobalStartMyProc, &Remainder, &Top);
+    ProcNumUpdates = (s64Int) UpdatesPerEntry * LocalTableSize;
+    NumUpdates = (double) UpdatesPerEntry * TableSize;
+
+    for (i=0; i<LocalTableSize; i++)
+      HPCC_Table[i] = MyProc;
+    RealTime = LocalRandomAccessUpdate(logT, TableSize, LocalTableSize,
+                                       MinLocalTableSize, GlobalStartMyProc, Top,
+                                       logNumProcs, NumProcs, Remainder, MyProc,
+                                       ProcNumUpdates);
+    if (MyProc == 0)
+      fprintf( outFile, "%8d %14.0f %14.9f", (int) logT,
+               (double) LocalTableSize * sizeof(u64Int), 1e-9*NumUpdates / RealTime );
+
+    for (c = 0; c < ncolumn; c++) {
+      mode = column[c];
+      for (i=0; i<LocalTableSize; i++)
+        HPCC_Table[i] = MyProc;
+      shmem_barrier_all();
+      RealTime = UpdateEngine[mode](logT, TableSize, LocalTableSize,
+                                    MinLocalTableSize, GlobalStartMyProc, Top,
+                                    logNumProcs, NumProcs, Remainder, MyProc,
+                                    ProcNumUpdates);
+      if (MyProc == 0)
+        fprintf( outFile, " %14.9f", 1e-9*NumUpdates / RealTime );
+    }
+    if (MyProc == 0)
+      fprintf( outFile, "\n" );
+  }
+}
+
+/* Parse a comma separated list of depths 1..max into depths[] */
+static int
+parse_depths(char *list, int *depths, int max)
+{
+  int depth, n = 0;
+  char *tok;
+
+  if (0 == strcmp(list, "sweep")) {
+    for (depth = 1; depth <= max && n < RA_MAX_WINDOWS; depth <<= 1)
+      depths[n++] = depth;
+    return n;
+  }
+  for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+    depth = atoi(tok);
+    if (depth < 1 || depth > max || n == RA_MAX_WINDOWS)
+      return -1;
+    depths[n++] = depth;
+  }
+  return n;
+}
+
+/* Parse a comma separated list of mode names into a bit mask */
+static int
+parse_modes(char *list)
+{
+  int mask = 0, mode;
+  char *tok;
+
+  for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+    if (0 == strcmp(tok, "all"))
+      return (1 << RA_NUM_MODES) - 1;
+    for (mode = 0; mode < RA_NUM_MODES; mode++)
+      if (0 == strcmp(tok, ModeName[mode]))
+        break;
+    if (mode == RA_NUM_MODES)
+      return -1;
+    mask |= 1 << mode;
+  }
+  return mask;
+}
+
 int main(int argc, char **argv)
 {
   int debug = 0;
@@ -66,8 +617,10 @@ int main(int argc, char **argv)
   s64Int LocalTableSize;    /* Local table width */
   u64Int MinLocalTableSize; /* Integer ratio TableSize/NumProcs */
   u64Int logTableSize, TableSize;
+  int Remainder;            /* Number of processors with (LocalTableSize + 1) entries */
 
   double CPUTime;               /* CPU  time to update table */
+  double CyclesMHz = 0;         /* get_cycles() ticks per microsecond */
   double RealTime;              /* Real time to update table */
 
   double TotalMem;
@@ -79,9 +632,9 @@ int main(int argc, char **argv)
                        * NumUpdates_Default due to execution time bounds */
   s64Int ProcNumUpdates; /* number of updates per processor */
   s64Int *NumErrors, *GlbNumErrors;
-#ifdef RA_TIME_BOUND
-  s64Int GlbNumUpdates;  /* for reduction */
-#endif
+  s64Int RunNumUpdates;  /* updates per processor in the timed run */
+  s64Int CalNumUpdates;  /* updates per processor in the time-bound calibration */
+  s64Int *ProcBound, *GlbNumUpdates;  /* for reduction */
 
   long *llpSync;
   long long *llpWrk;
@@ -96,26 +649,133 @@ int main(int argc, char **argv)
 
   int numthreads;
   int *sAbort, *rAbort;
+  int ModeMask = 1 << RA_MODE_GETPUT;
+  int CheckErrors = 0;
+  int SizeSweep = 0;
+  int LogLocalSize = -1;         /* -n: log2 words per PE */
+  double MemFraction = 0;        /* -f: fraction of node memory */
+  int UpdatesPerEntry = RA_DEFAULT_UPDATES_PER_ENTRY;
+  double NodeMem = 0;
+  int NodePEs = 1;
+  size_t PageSize = 0;           /* -p: huge page size for the table */
+  int DistReport = 0;            /* -d given: print received updates */
+  char DistArg[64];
+  long PageKb, ThpKb, VmaKb;
+  char *env;
+  int c;
 
   shmem_init();
 
+  /* Environment first, command line options override it */
+  if ((env = getenv("GUPS_LOG_LOCAL_SIZE")) != NULL)
+    LogLocalSize = atoi(env);
+  if ((env = getenv("GUPS_MEM_FRACTION")) != NULL)
+    MemFraction = atof(env);
+  if ((env = getenv("GUPS_UPDATES_PER_ENTRY")) != NULL)
+    UpdatesPerEntry = atoi(env);
+#ifdef RA_TIME_BOUND
+  timeBound = RA_DEFAULT_TIME_BOUND;
+#endif
+  if ((env = getenv("GUPS_TIME_BOUND")) != NULL)
+    timeBound = atof(env);
+  if ((env = getenv("GUPS_LAT_SAMPLE")) != NULL)
+    RA_LatSample = atoi(env);
+  if ((env = getenv("GUPS_PAGE_SIZE")) != NULL)
+    PageSize = parse_size(env);
+  if ((env = getenv("GUPS_DIST")) != NULL) {
+    snprintf(DistArg, sizeof(DistArg), "%s", env);
+    RA_Dist = parse_dist(DistArg);
+    DistReport = 1;
+  }
+
+  while ((c = getopt(argc, argv, "m:w:k:n:f:u:t:l:p:d:svh")) != -1)
+    switch (c) {
+    case 'm':
+      ModeMask = parse_modes(optarg);
+      if (ModeMask <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'w':
+      /* HPCC limits the look-ahead to MAX_TOTAL_PENDING_UPDATES */
+      if ((NumWindows = parse_depths(optarg, Windows, MAX_TOTAL_PENDING_UPDATES)) <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'k':
+      if ((NumPrefetches = parse_depths(optarg, Prefetches, RA_STREAM_BLOCK)) <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'n':
+      LogLocalSize = atoi(optarg);
+      MemFraction = 0;
+      break;
+    case 'f':
+      MemFraction = atof(optarg);
+      LogLocalSize = -1;
+      break;
+    case 'u':
+      UpdatesPerEntry = atoi(optarg);
+      break;
+    case 't':
+      timeBound = atof(optarg);
+      break;
+    case 'l':
+      RA_LatSample = atoi(optarg);
+      break;
+    case 'p':
+      PageSize = parse_size(optarg);
+      break;
+    case 'd':
+      RA_Dist = parse_dist(optarg);
+      DistReport = 1;
+      break;
+    case 's':
+      SizeSweep = 1;
+      break;
+    case 'v':
+      CheckErrors = 1;
+      break;
+    case 'h':
+    default:
+      if (0 == shmem_my_pe()) usage(argv[0]);
+      shmem_finalize();
+      return 'h' == c ? 0 : 1;
+    }
+
+  if (LogLocalSize > 40 || MemFraction < 0 || MemFraction > 1 || UpdatesPerEntry < 1 ||
+      (PageSize & (PageSize - 1)) != 0 || RA_Dist < 0 || RA_HotPE >= shmem_n_pes()) {
+    if (0 == shmem_my_pe()) usage(argv[0]);
+    shmem_finalize();
+    return 1;
+  }
+
   /*Allocate symmetric memory*/
   sAbort = (int *)shmem_malloc(sizeof(int));
   rAbort = (int *)shmem_malloc(sizeof(int));
-  llpSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_BCAST_SYNC_SIZE);
+  llpSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_REDUCE_SYNC_SIZE);
   llpWrk = (long long *)shmem_malloc(sizeof(long long) * _SHMEM_REDUCE_SYNC_SIZE);
-  ipSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_BCAST_SYNC_SIZE);
+  ipSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_REDUCE_SYNC_SIZE);
   ipWrk = (int *)shmem_malloc(sizeof(int) * _SHMEM_REDUCE_SYNC_SIZE);
 
   GUPs = (double *)shmem_malloc(sizeof(double));
   temp_GUPs = (double *)shmem_malloc(sizeof(double));
   GlbNumErrors = (s64Int *)shmem_malloc(sizeof(s64Int));
   NumErrors = (s64Int *)shmem_malloc(sizeof(s64Int));
+  ProcBound = (s64Int *)shmem_malloc(sizeof(s64Int));
+  GlbNumUpdates = (s64Int *)shmem_malloc(sizeof(s64Int));
 
   *GlbNumErrors = 0;
   *NumErrors = 0;
 
-  for (i = 0; i < _SHMEM_BCAST_SYNC_SIZE; i += 1){
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i += 1){
         ipSync[i] = _SHMEM_SYNC_VALUE;
         llpSync[i] = _SHMEM_SYNC_VALUE;
   }
@@ -130,7 +790,20 @@ int main(int argc, char **argv)
     setbuf(outFile, NULL);
   }
 
-  TotalMem = 20000000; /* max single node memory */
+  if (LogLocalSize >= 0)
+    TotalMem = ldexp(1.0, LogLocalSize) * sizeof(u64Int);
+  else if (MemFraction > 0) {
+    NodeMem = node_memory();
+    NodePEs = node_pes(sAbort, NumProcs);
+    TotalMem = MemFraction * NodeMem / NodePEs;
+    if (TotalMem < sizeof(u64Int)) {
+      if (MyProc == 0) fprintf(outFile, "Cannot determine node memory, using the default table size.\n");
+      TotalMem = RA_DEFAULT_PE_MEM;
+      MemFraction = 0;
+    }
+  }
+  else
+    TotalMem = RA_DEFAULT_PE_MEM; /* max single node memory */
   TotalMem *= NumProcs;             /* max memory in NumProcs nodes */
 
   TotalMem /= sizeof(u64Int);
@@ -142,14 +815,25 @@ int main(int argc, char **argv)
     ; /* EMPTY */
 
 
-  MinLocalTableSize = (TableSize / NumProcs);
-  LocalTableSize = MinLocalTableSize;
-  GlobalStartMyProc = (MinLocalTableSize * MyProc);
+  for (i = 1, logNumProcs = 0; ; logNumProcs++, i <<= 1) {
+    if (i == NumProcs) {
+      PowerofTwo = HPCC_TRUE;
+      break;
+    }
+    if (i > NumProcs) {
+      PowerofTwo = HPCC_FALSE;
+      break;
+    }
+  }
+
+  table_layout(logTableSize, NumProcs, MyProc, &TableSize, &MinLocalTableSize,
+               &LocalTableSize, &GlobalStartMyProc, &Remainder, &Top);
 
   *sAbort = 0;
 
-  /*Shmalloc HPCC_Table for RMA*/
-  HPCC_Table = (u64Int *)shmem_malloc( sizeof(u64Int)*LocalTableSize );
+  /*Shmalloc HPCC_Table for RMA; the size must match on every PE*/
+  HPCC_Table = table_alloc( sizeof(u64Int)*(MinLocalTableSize + (Remainder > 0)),
+                            PageSize, MyProc, outFile );
   if (! HPCC_Table) *sAbort = 1;
 
 
@@ -159,15 +843,44 @@ int main(int argc, char **argv)
 
   if (*rAbort > 0) {
     if (MyProc == 0) fprintf(outFile, "Failed to allocate memory for the main table.\n");
+    if (MyProc == 0 && PageSize)
+      fprintf(outFile, "The table is padded to whole %lu KiB pages; SHMEM_SYMMETRIC_SIZE may need raising.\n",
+              (unsigned long) (PageSize >> 10));
     /* check all allocations in case there are new added and their order changes */
-    if (HPCC_Table) HPCC_free( HPCC_Table );
+    if (HPCC_Table) shmem_free( HPCC_Table );
     goto failed_table;
   }
 
+  RA_PesPerNode = node_pes(HPCC_Table, NumProcs);
+
+  RA_PeTable = XMALLOC(u64Int *, NumProcs);
+  if (! RA_PeTable) {
+    fprintf(stderr, "PE%d: failed to allocate the shmem_ptr table\n", MyProc);
+    shmem_global_exit(1);
+  }
+  for (i = 0; i < NumProcs; i++)
+    RA_PeTable[i] = (u64Int *)shmem_ptr(HPCC_Table, (int) i);
+
+  /* Cycle counter rate for the latency report; fall back to timing it */
+  if (RA_LatSample < 0)
+    RA_LatSample = 0;
+  if (RA_LatSample) {
+    cycles_t c0;
+
+    CyclesMHz = get_cpu_mhz(1);
+    if (CyclesMHz <= 0) {
+      c0 = get_cycles();
+      RealTime = RTSEC();
+      while (RTSEC() - RealTime < 0.1)
+        ; /* EMPTY */
+      CyclesMHz = (get_cycles() - c0) / (1e6 * (RTSEC() - RealTime));
+    }
+  }
+
   /* Default number of global updates to table: 4x number of table entries */
   NumUpdates_Default = 4 * TableSize;
-  ProcNumUpdates = 4*LocalTableSize;
-  NumUpdates = NumUpdates_Default;
+  ProcNumUpdates = (s64Int) UpdatesPerEntry * LocalTableSize;
+  NumUpdates = (u64Int) UpdatesPerEntry * TableSize;
 
   if (MyProc == 0) {
     fprintf( outFile, "Running on %d processors%s\n", NumProcs, PowerofTwo ? " (PowerofTwo)" : "");
@@ -179,7 +892,24 @@ int main(int argc, char **argv)
         fprintf( outFile, "PE Main table size = (2^" FSTR64 ")/%d  = " FSTR64 " words/PE MAX\n",
                  logTableSize, NumProcs, LocalTableSize);
 
-    fprintf( outFile, "Default number of updates (RECOMMENDED) = " FSTR64 "\tand actually done = %d\n", NumUpdates_Default,ProcNumUpdates*NumProcs);
+    fprintf( outFile, "PE table footprint = " FSTR64 " bytes (%.2f MiB)\n",
+             LocalTableSize * (s64Int) sizeof(u64Int),
+             LocalTableSize * sizeof(u64Int) / 1048576.0 );
+    if ((PageKb = table_page_kb(HPCC_Table, &ThpKb, &VmaKb)) > 0)
+      fprintf( outFile, "Table pages: %ld KiB, %ld of %ld KiB of the mapping in transparent huge pages%s\n",
+               PageKb, ThpKb, VmaKb, PageSize ? "" : " (-p not set)" );
+    if (MemFraction > 0)
+      fprintf( outFile, "Node memory = %.2f GiB shared by %d PEs, fraction used = %.3f\n",
+               NodeMem / 1073741824.0, NodePEs, MemFraction );
+    if (RA_Dist == RA_DIST_ZIPF)
+      fprintf( outFile, "Address distribution: Zipf, s = %.3f\n", RA_ZipfS );
+    else if (RA_Dist == RA_DIST_HOT)
+      fprintf( outFile, "Address distribution: %.1f%% of the updates to PE %d\n",
+               100 * RA_HotFraction, RA_HotPE );
+    if (ModeMask & (1 << RA_MODE_ROUTE))
+      fprintf( outFile, "Routing through %d nodes of %d PEs\n",
+               (NumProcs + RA_PesPerNode - 1) / RA_PesPerNode, RA_PesPerNode );
+    fprintf( outFile, "Default number of updates (RECOMMENDED) = " FSTR64 "\tand actually done = " FSTR64 "\n", NumUpdates_Default,NumUpdates);
   }
 
   /* Initialize main table */
@@ -188,112 +918,183 @@ int main(int argc, char **argv)
 
   shmem_barrier_all();
 
-  int j,k;
-  int logTableLocal,ipartner,iterate,niterate;
-  int ndata,nkeep,nsend,nrecv,index,nlocalm1;
-  int numthrds;
-  u64Int datum,procmask;
-  u64Int *data,*send;
-  void * tstatus;
-  int remote_proc, offset;
-  u64Int *tb;
-  s64Int remotecount;
-  int thisPeId;
-  int numNodes;
-  int count2;
-
-  s64Int *count;
-  s64Int *updates;
-  s64Int *all_updates;
-  s64Int *ran;
-
-  thisPeId = shmem_my_pe();
-  numNodes = shmem_n_pes();
-
-  count = (s64Int *) shmem_malloc(sizeof(s64Int));
-  ran = (s64Int *) shmem_malloc(sizeof(s64Int));
-  updates = (s64Int *) shmem_malloc(sizeof(s64Int) * numNodes);/* An array of length npes to avoid overwrites*/
-  all_updates = (s64Int *) shmem_malloc(sizeof(s64Int) * numNodes);/*: An array to collect sum*/
-
-  *ran = starts(4*GlobalStartMyProc);
-
-  niterate = ProcNumUpdates;
-  logTableLocal = logTableSize - logNumProcs;
-  nlocalm1 = LocalTableSize - 1;
-
-  
-  for (j = 0; j < numNodes; j++){
-    updates[j] = 0;
-    all_updates = 0;
-  }
-  int verify=0; 
-  u64Int remote_val;
+  int j, mode, variant, nvariants;
+  RA_Run_t Runs[RA_MAX_RUNS], *run;
+  int NumRuns = 0;
 
-  shmem_barrier_all();
-  /* Begin timed section */
-  RealTime = -RTSEC();
-  for (iterate = 0; iterate < niterate; iterate++) {
-      *ran = (*ran << 1) ^ ((s64Int) *ran < ZERO64B ? POLY : ZERO64B);
-      remote_proc = (*ran >> logTableLocal) & (numNodes - 1);
-
-      /*Forces updates to remote PE only*/
-      if(remote_proc == MyProc)
-        remote_proc = (remote_proc+1)/numNodes;
-
-      remote_val  = shmem_longlong_g( &HPCC_Table[*ran & (LocalTableSize-1)],remote_proc);
-      remote_val ^= *ran;
-      shmem_longlong_p(&HPCC_Table[*ran & (LocalTableSize-1)],remote_val, remote_proc);
-      shmem_quiet();
-
-      if(verify)
-        shmem_longlong_inc(&updates[thisPeId], remote_proc);
+  if (SizeSweep) {
+    size_sweep(outFile, ModeMask, logTableSize, logNumProcs, NumProcs, MyProc,
+               UpdatesPerEntry);
+    ModeMask = 0;
   }
-  
-  shmem_barrier_all();
-  /* End timed section */
-  RealTime += RTSEC();
-
-
 
-  /* Print timing results */
-  if (MyProc == 0){
-    *GUPs = 1e-9*NumUpdates / RealTime;
-    fprintf( outFile, "Real time used = %.6f seconds\n", RealTime );
-    fprintf( outFile, "%.9f Billion(10^9) Updates    per second [GUP/s]\n",
-             *GUPs );
-    fprintf( outFile, "%.9f Billion(10^9) Updates/PE per second [GUP/s]\n",
-             *GUPs / NumProcs );
-  }
- 
-  if(verify){
-    for (j = 1; j < numNodes; j++)
-      updates[0] += updates[j];
-    int cpu = sched_getcpu();
-    printf("PE%d CPU%d  updates:%d\n",MyProc,cpu,updates[0]);
-
-    shmem_longlong_sum_to_all(all_updates,updates, NumProcs, 0,0, NumProcs,llpWrk, llpSync);
-    if(MyProc == 0){
-      for (j = 1; j < numNodes; j++)
-        all_updates[0] += all_updates[j];
-      if(ProcNumUpdates*NumProcs == all_updates[0])
-        printf("Verification passed!\n");
+  for (mode = 0; mode < RA_NUM_MODES; mode++) {
+    if (! (ModeMask & (1 << mode)))
+      continue;
+
+    /* The windowed engines are run once per requested window depth, the
+     * prefetch engine once per prefetch distance */
+    nvariants = (mode == RA_MODE_NBI || mode == RA_MODE_FETCHNBI) ? NumWindows :
+                (mode == RA_MODE_PREFETCH) ? NumPrefetches : 1;
+    for (variant = 0; variant < nvariants; variant++) {
+      run = &Runs[NumRuns++];
+      if (mode == RA_MODE_NBI || mode == RA_MODE_FETCHNBI) {
+        RA_Window = Windows[variant];
+        snprintf(run->name, sizeof(run->name), "%s/%d", ModeName[mode], RA_Window);
+      }
+      else if (mode == RA_MODE_PREFETCH) {
+        RA_Prefetch = Prefetches[variant];
+        snprintf(run->name, sizeof(run->name), "%s/%d", ModeName[mode], RA_Prefetch);
+      }
       else
-        printf("Verification failed!\n");
+        snprintf(run->name, sizeof(run->name), "%s", ModeName[mode]);
+
+      /* Every engine starts from the same initial table */
+      for (i=0; i<LocalTableSize; i++)
+        HPCC_Table[i] = MyProc;
+      shmem_barrier_all();
+
+      /* HPCC time bound: time a short batch, then run as many updates as
+       * the slowest PE fits in timeBound seconds (never more than the
+       * full run) */
+      RunNumUpdates = ProcNumUpdates;
+      if (timeBound > 0) {
+        CalNumUpdates = ProcNumUpdates / RA_TIME_BOUND_SAMPLE;
+        if (CalNumUpdates < LOCAL_BUFFER_SIZE)
+          CalNumUpdates = ProcNumUpdates < LOCAL_BUFFER_SIZE ? ProcNumUpdates : LOCAL_BUFFER_SIZE;
+        RealTime = UpdateEngine[mode](logTableSize, TableSize, LocalTableSize,
+                                      MinLocalTableSize, GlobalStartMyProc, Top,
+                                      logNumProcs, NumProcs, Remainder, MyProc,
+                                      CalNumUpdates);
+        *ProcBound = RealTime > 0 ? (s64Int) (CalNumUpdates * timeBound / RealTime) : ProcNumUpdates;
+        if (*ProcBound < 1)
+          *ProcBound = 1;
+        shmem_longlong_min_to_all((long long *)GlbNumUpdates, (long long *)ProcBound,
+                                  1, 0,0, NumProcs, llpWrk, llpSync);
+        if (*GlbNumUpdates < RunNumUpdates)
+          RunNumUpdates = *GlbNumUpdates;
+
+        for (i=0; i<LocalTableSize; i++)
+          HPCC_Table[i] = MyProc;
+        shmem_barrier_all();
+      }
+
+      for (j = 0; j < RA_LAT_BUCKETS; j++)
+        RA_LatHist[j] = 0;
+      RA_LatMax = 0;
+
+      RealTime = UpdateEngine[mode](logTableSize, TableSize, LocalTableSize,
+                                    MinLocalTableSize, GlobalStartMyProc, Top,
+                                    logNumProcs, NumProcs, Remainder, MyProc,
+                                    RunNumUpdates);
+      run->time = RealTime;
+      run->errors = 0;
+
+      /* Updates actually performed, summed over the PEs */
+      *ProcBound = RunNumUpdates;
+      shmem_longlong_sum_to_all((long long *)GlbNumUpdates, (long long *)ProcBound,
+                                1, 0,0, NumProcs, llpWrk, llpSync);
+      shmem_barrier_all();
+      run->updates = (double) *GlbNumUpdates;
+
+      /* Print timing results */
+      if (MyProc == 0){
+        *GUPs = 1e-9*run->updates / RealTime;
+        fprintf( outFile, "Update mode: %s\n", run->name );
+        if (timeBound > 0)
+          fprintf( outFile, "Time bound = %.3f seconds, calibrated on %lld updates/PE, "
+                   "updates done = %.0f (%.1f%%)\n", timeBound, (long long) CalNumUpdates,
+                   run->updates, 100.0 * run->updates / NumUpdates );
+        fprintf( outFile, "Real time used = %.6f seconds\n", RealTime );
+        fprintf( outFile, "%.9f Billion(10^9) Updates    per second [GUP/s]\n",
+                 *GUPs );
+        fprintf( outFile, "%.9f Billion(10^9) Updates/PE per second [GUP/s]\n",
+                 *GUPs / NumProcs );
+      }
+
+      if (RA_LatSample && (mode == RA_MODE_GETPUT || mode == RA_MODE_AMO))
+        lat_report(outFile, NumProcs, MyProc, CyclesMHz);
+
+      if (DistReport && mode != RA_MODE_LOCAL && mode != RA_MODE_PREFETCH)
+        dist_report(outFile, logTableSize, TableSize, LocalTableSize, MinLocalTableSize,
+                    GlobalStartMyProc, Top, logNumProcs, NumProcs, Remainder, MyProc,
+                    RunNumUpdates);
+
+      if (mode == RA_MODE_FETCHNBI) {
+        shmem_longlong_xor_to_all((long long *)&GlbChecksum, (long long *)&RA_Checksum,
+                                  1, 0,0, NumProcs, llpWrk, llpSync);
+        if (MyProc == 0) {
+          fprintf( outFile, "Fetched-value checksum = 0x%016llx\n",
+                   (unsigned long long) GlbChecksum );
+#if ! RA_SHMEM_AT_LEAST(1, 5)
+          fprintf( outFile, "(OpenSHMEM %d.%d: blocking shmem_atomic_fetch_xor, "
+                   "no fetch_xor_nbi before 1.5)\n", SHMEM_MAJOR_VERSION, SHMEM_MINOR_VERSION );
+#endif
+        }
+      }
+      shmem_barrier_all();
+
+      if (mode == RA_MODE_PTR) {
+        shmem_longlong_sum_to_all((long long *)GlbNodeUpdates, (long long *)RA_NodeUpdates,
+                                  2, 0,0, NumProcs, llpWrk, llpSync);
+        if (MyProc == 0)
+          for (j = RA_ON_NODE; j <= RA_OFF_NODE; j++)
+            fprintf( outFile, "%s updates = %lld (%.1f%%), %.6f seconds, %.9f GUP/s\n",
+                     j == RA_ON_NODE ? "On-node " : "Off-node",
+                     (long long) GlbNodeUpdates[j], 100.0 * GlbNodeUpdates[j] / run->updates,
+                     RA_NodeTime[j], RA_NodeTime[j] > 0 ?
+                     1e-9 * GlbNodeUpdates[j] / RA_NodeTime[j] : 0.0 );
+      }
+      shmem_barrier_all();
+
+      if (CheckErrors) {
+        RealTime = -RTSEC();
+        if (mode == RA_MODE_LOCAL || mode == RA_MODE_PREFETCH)
+          *NumErrors = LocalRandomAccessCheck(logTableSize, TableSize, LocalTableSize,
+                                              MinLocalTableSize, GlobalStartMyProc, Top,
+                                              logNumProcs, NumProcs, Remainder, MyProc,
+                                              RunNumUpdates);
+        else
+          *NumErrors = RandomAccessCheck(logTableSize, TableSize, LocalTableSize,
+                                         MinLocalTableSize, GlobalStartMyProc, Top,
+                                         logNumProcs, NumProcs, Remainder, MyProc,
+                                         RunNumUpdates);
+        shmem_longlong_sum_to_all(GlbNumErrors, NumErrors, 1, 0,0, NumProcs, llpWrk, llpSync);
+        RealTime += RTSEC();
+        run->errors = *GlbNumErrors;
+        if (MyProc == 0) {
+          fprintf( outFile, "Verification:  Real time used = %.6f seconds\n", RealTime );
+          fprintf( outFile, "Found " FSTR64 " errors in " FSTR64 " locations (%s).\n",
+                   *GlbNumErrors, TableSize, (*GlbNumErrors <= 0.01*TableSize) ?
+                   "passed" : "failed");
+        }
+        shmem_barrier_all();
+      }
+      /* End verification phase */
+    }
+  }
+
+  /* Side-by-side summary when more than one run was timed */
+  if (MyProc == 0 && NumRuns > 1) {
+    fprintf( outFile, "\n%-13s %14s %14s %14s", "Mode", "Seconds", "GUP/s", "GUP/s/PE" );
+    fprintf( outFile, CheckErrors ? " %14s\n" : "\n", "Errors" );
+    for (run = Runs; run < Runs + NumRuns; run++) {
+      fprintf( outFile, "%-13s %14.6f %14.9f %14.9f", run->name, run->time,
+               1e-9*run->updates / run->time, 1e-9*run->updates / run->time / NumProcs );
+      if (CheckErrors)
+        fprintf( outFile, " %14lld", (long long) run->errors );
+      fprintf( outFile, "\n" );
     }
   }
-  shmem_barrier_all();
-  /* End verification phase */
 
 
-  shmem_free(count);
-  shmem_free(updates);
-  shmem_free(ran);
   shmem_barrier_all();
 
   /* Deallocate memory (in reverse order of allocation which should
  *      help fragmentation) */
 
-  HPCC_free( HPCC_Table );
+  free( RA_PeTable );
+  shmem_free( HPCC_Table );
   failed_table:
 
   if (0 == MyProc) if (outFile != stderr) fclose( outFile );
@@ -302,6 +1103,8 @@ int main(int argc, char **argv)
 
   shmem_free(sAbort);
   shmem_free(rAbort);
+  shmem_free(GlbNumUpdates);
+  shmem_free(ProcBound);
   shmem_free(llpSync);
   shmem_free(llpWrk);
   shmem_free(ipSync);
@@ -313,48 +1116,3 @@ int main(int argc, char **argv)
 
   return 0;
 }
-
-/* Utility routine to start random number generator at Nth step */
-s64Int
-starts(u64Int n)
-{
-  /* s64Int i, j; */
-  int i, j;
-  u64Int m2[64];
-  u64Int temp, ran;
-
-  while (n < 0)
-    n += PERIOD;
-  while (n > PERIOD)
-    n -= PERIOD;
-  if (n == 0)
-    return 0x1;
-
-  temp = 0x1;
-  for (i=0; i<64; i++)
-    {
-      m2[i] = temp;
-      temp = (temp << 1) ^ ((s64Int) temp < 0 ? POLY : 0);
-      temp = (temp << 1) ^ ((s64Int) temp < 0 ? POLY : 0);
-    }
-
-  for (i=62; i>=0; i--)
-    if ((n >> i) & 1)
-      break;
-
-  ran = 0x2;
-
-  while (i > 0)
-    {
-      temp = 0;
-      for (j=0; j<64; j++)
-        if ((ran >> j) & 1)
-          temp ^= m2[j];
-      ran = temp;
-      i -= 1;
-      if ((n >> i) & 1)
-        ran = (ran << 1) ^ ((s64Int) ran < 0 ? POLY : 0);
-    }
-
-  return ran;
-}
@@ -0,0 +1,140 @@
+/* -*- mode: C; tab-width: 2; indent-tabs-mode: nil; -*- */
+
+/*
+ * Error check for the OpenSHMEM RandomAccess benchmark.
+ *
+ * As in HPCC, the update stream is regenerated and applied a second time.
+ * Since every update is an XOR, a table that received all updates exactly
+ * once returns to its initial state (HPCC_Table[i] == MyProc); every word
+ * that does not is counted as an error.  HPCC accepts up to 1% errors, which
+ * covers the races of the non-atomic update modes.
+ */
+
+#include <hpcc.h>
+#include <stdio.h>
+#include "RandomAccess.h"
+#include <shmem.h>
+
+/*
+ * All PEs replay their stream at once with non-fetching shmem_atomic_xor,
+ * so the check runs as fast as the amo engine and cannot lose updates to
+ * races of its own; the barrier completes the XORs before the local count.
+ */
+s64Int
+RandomAccessCheck(u64Int logTableSize,
+                  u64Int TableSize,
+                  u64Int LocalTableSize,
+                  u64Int MinLocalTableSize,
+                  u64Int GlobalStartMyProc,
+                  u64Int Top,
+                  int logNumProcs,
+                  int NumProcs,
+                  int Remainder,
+                  int MyProc,
+                  s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, i, errors;
+  int logTableLocal, remote_proc;
+  u64Int ran, offset;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+    nblock = ProcNumUpdates - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++) {
+      ran = block[i];
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+      shmem_atomic_xor(&HPCC_Table[offset], ran, remote_proc);
+    }
+  }
+  shmem_barrier_all();
+
+  for (i = 0, errors = 0; i < LocalTableSize; i++)
+    if (HPCC_Table[i] != (u64Int) MyProc)
+      errors++;
+
+  return errors;
+}
+
+/*
+ * The local modes update only the PE's own slice, so the replay is the
+ * local pass itself; its barriers keep the PEs in step with the others.
+ */
+s64Int
+LocalRandomAccessCheck(u64Int logTableSize,
+                       u64Int TableSize,
+                       u64Int LocalTableSize,
+                       u64Int MinLocalTableSize,
+                       u64Int GlobalStartMyProc,
+                       u64Int Top,
+                       int logNumProcs,
+                       int NumProcs,
+                       int Remainder,
+                       int MyProc,
+                       s64Int ProcNumUpdates)
+{
+  s64Int i, errors;
+
+  LocalRandomAccessUpdate(logTableSize, TableSize, LocalTableSize,
+                          MinLocalTableSize, GlobalStartMyProc, Top,
+                          logNumProcs, NumProcs, Remainder, MyProc,
+                          ProcNumUpdates);
+
+  for (i = 0, errors = 0; i < LocalTableSize; i++)
+    if (HPCC_Table[i] != (u64Int) MyProc)
+      errors++;
+
+  return errors;
+}
+
+/*
+ * Received-update accounting for skewed distributions: this PE's stream is
+ * regenerated outside the timed section and every update is counted
+ * against its target PE, so the engines' loops stay as they are.  Summed
+ * over the PEs this gives the updates each PE received.
+ */
+void
+RandomAccessTargets(s64Int *counts,
+                    u64Int logTableSize,
+                    u64Int TableSize,
+                    u64Int LocalTableSize,
+                    u64Int MinLocalTableSize,
+                    u64Int GlobalStartMyProc,
+                    u64Int Top,
+                    int logNumProcs,
+                    int NumProcs,
+                    int Remainder,
+                    int MyProc,
+                    s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, i;
+  int logTableLocal;
+  u64Int offset;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+
+  logTableLocal = logTableSize - logNumProcs;
+  for (i = 0; i < NumProcs; i++)
+    counts[i] = 0;
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+    nblock = ProcNumUpdates - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++)
+      counts[RA_Target(block[i], logTableLocal, TableSize, MinLocalTableSize, Top,
+                       Remainder, NumProcs, MyProc, &offset)]++;
+  }
+}
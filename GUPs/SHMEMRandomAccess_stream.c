@@ -0,0 +1,232 @@
+/* -*- mode: C; tab-width: 2; indent-tabs-mode: nil; -*- */
+
+/*
+ * HPCC random stream for the OpenSHMEM RandomAccess benchmark.
+ *
+ * The stream is the sequence x^n in GF(2)[x] modulo x^64 + POLY: each step
+ * is ran = (ran << 1) ^ (carry ? POLY : 0).  Stepping RA_STREAM_LANES
+ * elements at once is a multiplication by x^RA_STREAM_LANES, which for
+ * fewer than 62 lanes is just (ran << L) ^ h ^ (h << 1) ^ (h << 2) with
+ * h = ran >> (64 - L).  RA_StreamFill() keeps RA_STREAM_LANES interleaved
+ * copies of the stream in one vector (AVX-512), two (AVX2) or plain
+ * scalars, so a block of updates is generated without the serial
+ * dependency and in exactly the order of the scalar loop.
+ */
+
+#include <hpcc.h>
+#include "RandomAccess.h"
+#if defined(__AVX2__) || defined(__AVX512F__) || defined(__PCLMUL__)
+#include <immintrin.h>
+#endif
+
+/* Multiply by x^RA_STREAM_LANES: shift, then fold the carried-out bits */
+static inline u64Int
+lane_step(u64Int v)
+{
+  u64Int h = v >> (64 - RA_STREAM_LANES);
+
+  return (v << RA_STREAM_LANES) ^ h ^ (h << 1) ^ (h << 2);
+}
+
+/*
+ * a * b modulo x^64 + POLY, carry-less.  Uses PCLMULQDQ where the compiler
+ * targets it, otherwise a 4-bit table of multiples of a.
+ */
+static u64Int
+mulmod(u64Int a, u64Int b)
+{
+  u64Int lo, hi, over;
+#ifdef __PCLMUL__
+  __m128i p;
+
+  p = _mm_clmulepi64_si128(_mm_cvtsi64_si128((long long) a),
+                           _mm_cvtsi64_si128((long long) b), 0);
+  lo = (u64Int) _mm_cvtsi128_si64(p);
+  hi = (u64Int) _mm_cvtsi128_si64(_mm_unpackhi_epi64(p, p));
+#else
+  u64Int tab_lo[16], tab_hi[16];
+  int i;
+
+  /* a times every polynomial of degree < 4; at most 3 bits spill over */
+  tab_lo[0] = tab_hi[0] = 0;
+  for (i = 1; i < 16; i++) {
+    if (i & 1) {
+      tab_lo[i] = tab_lo[i-1] ^ a;
+      tab_hi[i] = tab_hi[i-1];
+    }
+    else {
+      tab_lo[i] = tab_lo[i>>1] << 1;
+      tab_hi[i] = (tab_hi[i>>1] << 1) | (tab_lo[i>>1] >> 63);
+    }
+  }
+
+  lo = hi = 0;
+  for (i = 60; i >= 0; i -= 4) {
+    hi = (hi << 4) | (lo >> 60);
+    lo = (lo << 4) ^ tab_lo[(b >> i) & 15];
+    hi ^= tab_hi[(b >> i) & 15];
+  }
+#endif
+
+  /* hi * x^64 = hi * POLY; fold the (at most 2) bits that spill again */
+  over = (hi >> 63) ^ (hi >> 62);
+  return lo ^ hi ^ (hi << 1) ^ (hi << 2) ^ over ^ (over << 1) ^ (over << 2);
+}
+
+/* Utility routine to start random number generator at Nth step */
+s64Int
+starts(u64Int n)
+{
+  int i;
+  u64Int ran;
+
+  while (n < 0)
+    n += PERIOD;
+  while (n > PERIOD)
+    n -= PERIOD;
+  if (n == 0)
+    return 0x1;
+
+  /* x^n by square-and-multiply: 63 carry-less squarings at most */
+  for (i=62; i>=0; i--)
+    if ((n >> i) & 1)
+      break;
+
+  ran = 0x2;
+  while (i > 0)
+    {
+      ran = mulmod(ran, ran);
+      i -= 1;
+      if ((n >> i) & 1)
+        ran = (ran << 1) ^ ((s64Int) ran < 0 ? POLY : 0);
+    }
+
+  return ran;
+}
+
+/* Position s so that the next element filled is the one after starts(n) */
+void
+RA_StreamInit(RA_Stream_t *s, u64Int n)
+{
+  u64Int ran;
+  int k;
+
+  ran = starts(n);
+  for (k = 0; k < RA_STREAM_LANES; k++) {
+    ran = (ran << 1) ^ ((s64Int) ran < ZERO64B ? POLY : ZERO64B);
+    s->lane[k] = ran;
+  }
+  s->nspare = 0;
+}
+
+/* Store the next count elements of the stream in buf */
+void
+RA_StreamFill(RA_Stream_t *s, u64Int *buf, s64Int count)
+{
+  s64Int i = 0, rows;
+  int k;
+
+  /* Rest of a row split by the previous call */
+  for (; s->nspare > 0 && i < count; s->nspare--)
+    buf[i++] = s->spare[RA_STREAM_LANES - s->nspare];
+
+  rows = (count - i) / RA_STREAM_LANES;
+
+#if defined(__AVX512F__) && RA_STREAM_LANES == 8
+  {
+    __m512i v, h;
+
+    v = _mm512_loadu_si512((void *) s->lane);
+    for (; rows > 0; rows--, i += RA_STREAM_LANES) {
+      _mm512_storeu_si512((void *) &buf[i], v);
+      h = _mm512_srli_epi64(v, 64 - RA_STREAM_LANES);
+      v = _mm512_xor_si512(_mm512_slli_epi64(v, RA_STREAM_LANES),
+                           _mm512_xor_si512(h, _mm512_xor_si512(_mm512_slli_epi64(h, 1),
+                                                                _mm512_slli_epi64(h, 2))));
+    }
+    _mm512_storeu_si512((void *) s->lane, v);
+  }
+#elif defined(__AVX2__) && RA_STREAM_LANES == 8
+  {
+    __m256i v0, v1, h0, h1;
+
+    v0 = _mm256_loadu_si256((__m256i *) &s->lane[0]);
+    v1 = _mm256_loadu_si256((__m256i *) &s->lane[4]);
+    for (; rows > 0; rows--, i += RA_STREAM_LANES) {
+      _mm256_storeu_si256((__m256i *) &buf[i], v0);
+      _mm256_storeu_si256((__m256i *) &buf[i+4], v1);
+      h0 = _mm256_srli_epi64(v0, 64 - RA_STREAM_LANES);
+      h1 = _mm256_srli_epi64(v1, 64 - RA_STREAM_LANES);
+      v0 = _mm256_xor_si256(_mm256_slli_epi64(v0, RA_STREAM_LANES),
+                            _mm256_xor_si256(h0, _mm256_xor_si256(_mm256_slli_epi64(h0, 1),
+                                                                  _mm256_slli_epi64(h0, 2))));
+      v1 = _mm256_xor_si256(_mm256_slli_epi64(v1, RA_STREAM_LANES),
+                            _mm256_xor_si256(h1, _mm256_xor_si256(_mm256_slli_epi64(h1, 1),
+                                                                  _mm256_slli_epi64(h1, 2))));
+    }
+    _mm256_storeu_si256((__m256i *) &s->lane[0], v0);
+    _mm256_storeu_si256((__m256i *) &s->lane[4], v1);
+  }
+#else
+  for (; rows > 0; rows--, i += RA_STREAM_LANES)
+    for (k = 0; k < RA_STREAM_LANES; k++) {
+      buf[i+k] = s->lane[k];
+      s->lane[k] = lane_step(s->lane[k]);
+    }
+#endif
+
+  /* Split the last row: hand out its head, keep the tail for next time */
+  if (i < count) {
+    for (k = 0; k < RA_STREAM_LANES; k++) {
+      s->spare[k] = s->lane[k];
+      s->lane[k] = lane_step(s->lane[k]);
+    }
+    for (s->nspare = RA_STREAM_LANES; i < count; s->nspare--)
+      buf[i++] = s->spare[RA_STREAM_LANES - s->nspare];
+  }
+}
+
+/*
+ * Table word addressed by ran under RA_Dist.  The value is hashed first:
+ * successive stream values are shifts of one another, so their own high
+ * bits would make the draws of neighbouring updates correlated.  Zipf
+ * ranks come from inverting the continuous CDF on [1, TableSize + 1) and
+ * are multiplied by an odd constant, which permutes them over the table so
+ * that the hot words land on arbitrary PEs.
+ */
+u64Int
+RA_SkewIndex(u64Int ran, u64Int TableSize, u64Int MinLocalTableSize, int Remainder)
+{
+  static u64Int zipf_size = 0;
+  static double zipf_span;
+  u64Int h, rank, start;
+  double u, x;
+
+  h = ran;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  u = (h >> 11) * (1.0 / 9007199254740992.0);   /* [0, 1) */
+
+  if (RA_Dist == RA_DIST_HOT) {
+    if (u >= RA_HotFraction)
+      return ran & (TableSize - 1);
+    start = RA_HotPE < Remainder ? (MinLocalTableSize + 1) * RA_HotPE
+                                 : MinLocalTableSize * RA_HotPE + Remainder;
+    return start + (h & (TableSize - 1)) % RA_LocalSize(RA_HotPE, MinLocalTableSize, Remainder);
+  }
+
+  if (zipf_size != TableSize) {
+    zipf_size = TableSize;
+    zipf_span = RA_ZipfS == 1.0 ? log(TableSize + 1.0)
+                                : pow(TableSize + 1.0, 1.0 - RA_ZipfS) - 1.0;
+  }
+  x = RA_ZipfS == 1.0 ? exp(u * zipf_span)
+                      : pow(1.0 + u * zipf_span, 1.0 / (1.0 - RA_ZipfS));
+  rank = x < 1.0 ? 0 : (u64Int) x - 1;
+  if (rank >= TableSize)
+    rank = TableSize - 1;
+  return (rank * 0x9E3779B97F4A7C15ULL) & (TableSize - 1);
+}
@@ -0,0 +1,1110 @@
+/* -*- mode: C; tab-width: 2; indent-tabs-mode: nil; -*- */
+
+/*
+ * Update engines for the OpenSHMEM RandomAccess benchmark.
+ *
+ * Every engine walks the same HPCC random stream (starting at
+ * starts(4*GlobalStartMyProc)) and targets the same table words, so the
+ * GUP/s they report can be compared directly.  Each engine does its own
+ * setup, times the update phase between two barriers and returns the
+ * elapsed real time.
+ */
+
+#include <hpcc.h>
+#include <stdio.h>
+#include <string.h>
+#include <sched.h>
+#include "RandomAccess.h"
+#include <shmem.h>
+
+u64Int LocalSendBuffer[LOCAL_BUFFER_SIZE];
+
+/*
+ * Reference engine: one blocking get, xor and put per update, completed
+ * with a quiet before the next update is issued.  This measures round-trip
+ * latency rather than update throughput.
+ */
+double
+GetPutRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates)
+{
+  s64Int iterate, sample_at;
+  int logTableLocal, remote_proc;
+  u64Int ran, remote_val, offset;
+  cycles_t t0 = 0;
+  double RealTime;
+
+  ran = starts(4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+  sample_at = RA_LatSample ? 0 : ProcNumUpdates;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate++) {
+      ran = (ran << 1) ^ ((s64Int) ran < ZERO64B ? POLY : ZERO64B);
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+      if (iterate == sample_at) {
+        sample_at += RA_LatSample;
+        t0 = get_cycles();
+      }
+
+      remote_val  = shmem_longlong_g( (long long *)&HPCC_Table[offset],remote_proc);
+      remote_val ^= ran;
+      shmem_longlong_p((long long *)&HPCC_Table[offset],remote_val, remote_proc);
+      shmem_quiet();
+
+      if (t0) {
+        RA_LatRecord(get_cycles() - t0);
+        t0 = 0;
+      }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  return RealTime;
+}
+
+/*
+ * XOR a received bucket of n updates into the local slice.  Words owned
+ * by another PE were redirected here by RA_Target and wrap the same way.
+ */
+static void
+apply_bucket(u64Int *in, int n, int logTableLocal, u64Int TableSize,
+             u64Int LocalTableSize, u64Int MinLocalTableSize, u64Int Top,
+             int Remainder, int MyProc)
+{
+  u64Int datum, offset;
+  int i;
+
+  for (i = 0; i < n; i++) {
+    datum = in[i];
+    if (RA_Owner(datum, logTableLocal, TableSize, MinLocalTableSize, Top,
+                 Remainder, &offset) != MyProc && offset >= LocalTableSize)
+      offset -= LocalTableSize;
+    HPCC_Table[offset] ^= datum;
+  }
+}
+
+/*
+ * Bucketed engine: each PE generates at most LOCAL_BUFFER_SIZE updates
+ * ahead (the HPCC look-ahead limit), sorts them into per-owner buckets and
+ * delivers every non-empty bucket with a single non-blocking put into the
+ * owner's mailbox.  After a barrier the owners apply the received XORs to
+ * their local slice of HPCC_Table.
+ *
+ * The mailboxes are double buffered so that only one barrier is needed per
+ * look-ahead window: window k+2 cannot be written before every PE has
+ * passed the barrier of window k+1, by which point window k was applied.
+ */
+double
+BucketRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates)
+{
+  s64Int iterate, nwindow, i;
+  int logTableLocal, pe, buf, nrecv;
+  u64Int ran, offset;
+  u64Int *mailbox;          /* [2][NumProcs][LOCAL_BUFFER_SIZE] */
+  long long *recv_count;    /* [2][NumProcs] */
+  long long *nwindows;      /* windows of the busiest PE */
+  long long *pWrk;
+  long *pSync;
+  int *bucket_count, *bucket_start;
+  RA_Stream_t stream;
+  double RealTime;
+
+  mailbox = (u64Int *)shmem_malloc(sizeof(u64Int) * 2 * NumProcs * LOCAL_BUFFER_SIZE);
+  recv_count = (long long *)shmem_malloc(sizeof(long long) * 2 * NumProcs);
+  nwindows = (long long *)shmem_malloc(sizeof(long long) * 2);
+  pWrk = (long long *)shmem_malloc(sizeof(long long) * _SHMEM_REDUCE_MIN_WRKDATA_SIZE);
+  pSync = (long *)shmem_malloc(sizeof(long) * _SHMEM_REDUCE_SYNC_SIZE);
+  bucket_count = XMALLOC(int, NumProcs);
+  bucket_start = XMALLOC(int, NumProcs + 1);
+  if (! mailbox || ! recv_count || ! nwindows || ! pWrk || ! pSync ||
+      ! bucket_count || ! bucket_start) {
+    fprintf(stderr, "PE%d: failed to allocate bucket buffers\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  for (i = 0; i < 2 * NumProcs; i++)
+    recv_count[i] = 0;
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i++)
+    pSync[i] = _SHMEM_SYNC_VALUE;
+
+  /* PEs may hold one word more or less, but all take part in every window */
+  nwindows[0] = (ProcNumUpdates + LOCAL_BUFFER_SIZE - 1) / LOCAL_BUFFER_SIZE;
+  shmem_barrier_all();
+  shmem_longlong_max_to_all(&nwindows[1], &nwindows[0], 1, 0, 0, NumProcs, pWrk, pSync);
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0, buf = 0; nwindows[1] > 0; iterate += nwindow, buf ^= 1, nwindows[1]--) {
+    u64Int *inbox = mailbox + (u64Int)buf * NumProcs * LOCAL_BUFFER_SIZE;
+    long long *incount = recv_count + buf * NumProcs;
+    u64Int window[LOCAL_BUFFER_SIZE];
+    int owner[LOCAL_BUFFER_SIZE];
+
+    nwindow = ProcNumUpdates - iterate;
+    if (nwindow > LOCAL_BUFFER_SIZE)
+      nwindow = LOCAL_BUFFER_SIZE;
+    if (nwindow < 0)
+      nwindow = 0;
+
+    /* Generate the window and count updates per owner */
+    for (pe = 0; pe < NumProcs; pe++)
+      bucket_count[pe] = 0;
+    RA_StreamFill(&stream, window, nwindow);
+    for (i = 0; i < nwindow; i++) {
+      ran = window[i];
+      owner[i] = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                           Remainder, NumProcs, MyProc, &offset);
+      bucket_count[owner[i]]++;
+    }
+
+    /* Counting sort into LocalSendBuffer */
+    bucket_start[0] = 0;
+    for (pe = 0; pe < NumProcs; pe++)
+      bucket_start[pe+1] = bucket_start[pe] + bucket_count[pe];
+    for (i = 0; i < nwindow; i++)
+      LocalSendBuffer[bucket_start[owner[i]]++] = window[i];
+
+    /* One bulk put per non-empty bucket, count trailing it */
+    for (pe = 0; pe < NumProcs; pe++) {
+      if (bucket_count[pe] == 0)
+        continue;
+      shmem_longlong_put_nbi((long long *)&inbox[(u64Int)MyProc * LOCAL_BUFFER_SIZE],
+                             (long long *)&LocalSendBuffer[bucket_start[pe] - bucket_count[pe]],
+                             bucket_count[pe], pe);
+      shmem_longlong_p(&incount[MyProc], bucket_count[pe], pe);
+    }
+
+    /* Completes all puts of this window on every PE */
+    shmem_barrier_all();
+
+    /* Apply what the other PEs sent us */
+    for (pe = 0; pe < NumProcs; pe++) {
+      nrecv = incount[pe];
+      if (nrecv == 0)
+        continue;
+      apply_bucket(&inbox[(u64Int)pe * LOCAL_BUFFER_SIZE], nrecv, logTableLocal,
+                   TableSize, LocalTableSize, MinLocalTableSize, Top, Remainder, MyProc);
+      incount[pe] = 0;
+    }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  free(bucket_start);
+  free(bucket_count);
+  shmem_free(pSync);
+  shmem_free(pWrk);
+  shmem_free(nwindows);
+  shmem_free(recv_count);
+  shmem_free(mailbox);
+
+  return RealTime;
+}
+
+/*
+ * State of the signal engine between its helpers: per source PE two
+ * mailbox slots and their signals, polled in order; per owner the buckets
+ * sent and the ones it has acknowledged.
+ */
+static u64Int *SigMailbox;      /* [NumProcs][2][LOCAL_BUFFER_SIZE], by source */
+static uint64_t *SigWord;       /* [NumProcs][2]: update count + 1, 0 if empty */
+static long long *SigAcked;     /* [NumProcs]: buckets each owner has applied */
+static long long *SigSent;      /* [NumProcs]: buckets sent to each owner */
+static int *SigStatus;          /* [NumProcs][2]: 1 excludes a slot from polling */
+static size_t *SigReady;        /* [NumProcs][2]: slots found ready */
+static int SigDone;             /* sources that ended their stream */
+
+/* Put n updates and their signal; before 1.5 a fence orders the two */
+static void
+put_signal(u64Int *dest, u64Int *src, int n, uint64_t *sig, uint64_t signal, int pe)
+{
+#if RA_SHMEM_AT_LEAST(1, 5)
+  shmem_uint64_put_signal_nbi((uint64_t *)dest, (uint64_t *)src, n, sig, signal,
+                              SHMEM_SIGNAL_SET, pe);
+#else
+  shmem_uint64_put_nbi((uint64_t *)dest, (uint64_t *)src, n, pe);
+  shmem_fence();
+  shmem_uint64_p(sig, signal, pe);
+#endif
+}
+
+/*
+ * Apply every bucket that has arrived, waiting for one if block is set.
+ * Slots are polled with shmem_wait_until_some/test_some where OpenSHMEM
+ * 1.5 has them, by scanning the signal words otherwise.  A slot's signal
+ * is cleared before the acknowledgement lets its source refill it.
+ */
+static void
+signal_service(int block, int logTableLocal, u64Int TableSize,
+               u64Int LocalTableSize, u64Int MinLocalTableSize, u64Int Top,
+               int NumProcs, int Remainder, int MyProc)
+{
+  size_t i, k, nready, n = 2 * NumProcs;
+  uint64_t signal;
+  int src;
+
+#if RA_SHMEM_AT_LEAST(1, 5)
+  if (block)
+    nready = shmem_uint64_wait_until_some(SigWord, n, SigReady, SigStatus, SHMEM_CMP_NE, 0);
+  else
+    nready = shmem_uint64_test_some(SigWord, n, SigReady, SigStatus, SHMEM_CMP_NE, 0);
+#else
+  for (;;) {
+    for (i = 0, nready = 0; i < n; i++)
+      if (! SigStatus[i] && ((volatile uint64_t *) SigWord)[i] != 0)
+        SigReady[nready++] = i;
+    if (nready > 0 || ! block)
+      break;
+    /* Idle: push our acknowledgements out and let oversubscribed PEs run */
+    shmem_quiet();
+    sched_yield();
+  }
+#endif
+
+  for (k = 0; k < nready; k++) {
+    i = SigReady[k];
+    src = i / 2;
+    signal = SigWord[i];
+    SigWord[i] = 0;
+    SigStatus[i] = 1;
+    if (signal == 1) {
+      SigDone++;
+      continue;
+    }
+    apply_bucket(&SigMailbox[i * LOCAL_BUFFER_SIZE], (int) signal - 1, logTableLocal,
+                 TableSize, LocalTableSize, MinLocalTableSize, Top, Remainder, MyProc);
+    SigStatus[i ^ 1] = 0;
+    shmem_atomic_inc(&SigAcked[MyProc], src);
+  }
+}
+
+/* Send n updates to pe once its next slot is free, serving our own meanwhile */
+static void
+signal_send(u64Int *buf, int n, int pe, int logTableLocal, u64Int TableSize,
+            u64Int LocalTableSize, u64Int MinLocalTableSize, u64Int Top,
+            int NumProcs, int Remainder, int MyProc)
+{
+  int slot = SigSent[pe] % 2;
+
+  while (((volatile long long *) SigAcked)[pe] < SigSent[pe] - 1) {
+    signal_service(0, logTableLocal, TableSize, LocalTableSize, MinLocalTableSize,
+                   Top, NumProcs, Remainder, MyProc);
+    shmem_quiet();
+    sched_yield();
+  }
+  put_signal(&SigMailbox[((u64Int)MyProc * 2 + slot) * LOCAL_BUFFER_SIZE], buf, n,
+             &SigWord[2*MyProc + slot], (uint64_t) n + 1, pe);
+  SigSent[pe]++;
+}
+
+/*
+ * Signalled bucket engine: the buckets of the bucket engine, delivered
+ * without a barrier.  Every bucket goes with shmem_put_signal_nbi into one
+ * of two mailbox slots the owner keeps per source PE, the signal carrying
+ * the update count + 1.  Owners poll the signals between their own windows
+ * and apply buckets as they arrive, then acknowledge them with
+ * shmem_atomic_inc so the source may reuse the slot; a source out of slots
+ * applies incoming buckets while it waits.  Each source's slots are
+ * consumed in order, so a bucket of 0 updates ends its stream.
+ */
+double
+SignalRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates)
+{
+  s64Int iterate, nwindow, i;
+  int logTableLocal, pe;
+  u64Int ran, offset;
+  int *bucket_count, *bucket_start;
+  RA_Stream_t stream;
+  double RealTime;
+
+  SigMailbox = (u64Int *)shmem_malloc(sizeof(u64Int) * NumProcs * 2 * LOCAL_BUFFER_SIZE);
+  SigWord = (uint64_t *)shmem_malloc(sizeof(uint64_t) * NumProcs * 2);
+  SigAcked = (long long *)shmem_malloc(sizeof(long long) * NumProcs);
+  SigSent = XMALLOC(long long, NumProcs);
+  SigStatus = XMALLOC(int, NumProcs * 2);
+  SigReady = XMALLOC(size_t, NumProcs * 2);
+  bucket_count = XMALLOC(int, NumProcs);
+  bucket_start = XMALLOC(int, NumProcs + 1);
+  if (! SigMailbox || ! SigWord || ! SigAcked || ! SigSent || ! SigStatus ||
+      ! SigReady || ! bucket_count || ! bucket_start) {
+    fprintf(stderr, "PE%d: failed to allocate signal buffers\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  /* Only the slot each source fills next is polled */
+  for (pe = 0; pe < NumProcs; pe++) {
+    SigWord[2*pe] = SigWord[2*pe + 1] = 0;
+    SigStatus[2*pe] = 0;
+    SigStatus[2*pe + 1] = 1;
+    SigAcked[pe] = 0;
+    SigSent[pe] = 0;
+  }
+  SigDone = 0;
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nwindow) {
+    u64Int window[LOCAL_BUFFER_SIZE];
+    int owner[LOCAL_BUFFER_SIZE];
+
+    nwindow = ProcNumUpdates - iterate;
+    if (nwindow > LOCAL_BUFFER_SIZE)
+      nwindow = LOCAL_BUFFER_SIZE;
+
+    for (pe = 0; pe < NumProcs; pe++)
+      bucket_count[pe] = 0;
+    RA_StreamFill(&stream, window, nwindow);
+    for (i = 0; i < nwindow; i++) {
+      ran = window[i];
+      owner[i] = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                           Remainder, NumProcs, MyProc, &offset);
+      bucket_count[owner[i]]++;
+    }
+
+    /* The previous window's puts may still read LocalSendBuffer */
+    shmem_quiet();
+    bucket_start[0] = 0;
+    for (pe = 0; pe < NumProcs; pe++)
+      bucket_start[pe+1] = bucket_start[pe] + bucket_count[pe];
+    for (i = 0; i < nwindow; i++)
+      LocalSendBuffer[bucket_start[owner[i]]++] = window[i];
+
+    for (pe = 0; pe < NumProcs; pe++)
+      if (bucket_count[pe] > 0)
+        signal_send(&LocalSendBuffer[bucket_start[pe] - bucket_count[pe]],
+                    bucket_count[pe], pe, logTableLocal, TableSize, LocalTableSize,
+                    MinLocalTableSize, Top, NumProcs, Remainder, MyProc);
+
+    signal_service(0, logTableLocal, TableSize, LocalTableSize, MinLocalTableSize,
+                   Top, NumProcs, Remainder, MyProc);
+  }
+
+  /* End every PE's stream from us, then drain ours */
+  for (pe = 0; pe < NumProcs; pe++)
+    signal_send(LocalSendBuffer, 0, pe, logTableLocal, TableSize, LocalTableSize,
+                MinLocalTableSize, Top, NumProcs, Remainder, MyProc);
+  while (SigDone < NumProcs)
+    signal_service(1, logTableLocal, TableSize, LocalTableSize, MinLocalTableSize,
+                   Top, NumProcs, Remainder, MyProc);
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  free(bucket_start);
+  free(bucket_count);
+  free(SigReady);
+  free(SigStatus);
+  free(SigSent);
+  shmem_free(SigAcked);
+  shmem_free(SigWord);
+  shmem_free(SigMailbox);
+
+  return RealTime;
+}
+
+/*
+ * Atomic engine: one non-fetching shmem_atomic_xor per update.  The XOR is
+ * performed at the owner (by the NIC where AMOs are offloaded), so updates
+ * from different PEs cannot race and no quiet is needed per update; the
+ * closing barrier completes them all.
+ */
+double
+AMORandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, i, sample_at;
+  int logTableLocal, remote_proc;
+  u64Int ran, offset;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+  cycles_t t0;
+  double RealTime;
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+  sample_at = RA_LatSample ? 0 : ProcNumUpdates;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+    nblock = ProcNumUpdates - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++) {
+      ran = block[i];
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+      if (iterate + i == sample_at) {
+        /* Sampled updates are completed on their own to time the round
+           trip; the XORs issued before are drained outside the sample */
+        sample_at += RA_LatSample;
+        shmem_quiet();
+        t0 = get_cycles();
+        shmem_atomic_xor(&HPCC_Table[offset], ran, remote_proc);
+        shmem_quiet();
+        RA_LatRecord(get_cycles() - t0);
+      }
+      else
+        shmem_atomic_xor(&HPCC_Table[offset], ran, remote_proc);
+    }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  return RealTime;
+}
+
+/*
+ * Table words read by the window being issued, so the nbi engine can end a
+ * window before it reads a word twice: the second get would return the
+ * value from before the first update's write-back and one of the two XORs
+ * would be lost.  The HPCC stream makes such repeats common (later values
+ * are shifts of earlier ones), far above the 1% error tolerance for deep
+ * windows.  Open addressing over a power of two; entries of older windows
+ * are told apart by their generation, so starting a window is O(1).
+ */
+typedef struct {
+  u64Int *word;
+  u64Int *gen;
+  u64Int mask, current;
+} RA_WindowSet_t;
+
+static int
+window_set_init(RA_WindowSet_t *set, int window)
+{
+  u64Int size = 2;
+
+  while (size < 2 * (u64Int) window)
+    size <<= 1;
+  set->word = XMALLOC(u64Int, size);
+  set->gen = XMALLOC(u64Int, size);
+  if (! set->word || ! set->gen)
+    return 1;
+  memset(set->gen, 0, size * sizeof(u64Int));
+  set->mask = size - 1;
+  set->current = 0;
+  return 0;
+}
+
+static void
+window_set_free(RA_WindowSet_t *set)
+{
+  free(set->gen);
+  free(set->word);
+}
+
+/* Add word to the current window's set; 1 if it was already there */
+static int
+window_set_insert(RA_WindowSet_t *set, u64Int word)
+{
+  u64Int h = ((word * 0x9E3779B97F4A7C15ULL) >> 32) & set->mask;
+
+  for (; set->gen[h] == set->current; h = (h + 1) & set->mask)
+    if (set->word[h] == word)
+      return 1;
+  set->gen[h] = set->current;
+  set->word[h] = word;
+  return 0;
+}
+
+/*
+ * Windowed engine: keeps RA_Window updates in flight.  The gets of a window
+ * are issued with shmem_longlong_get_nbi into a ring of local slots and
+ * retired together by a single quiet; the XORed values are then written
+ * back with shmem_longlong_p and completed by a second quiet before the
+ * next window reads the table, so a get never sees a word whose write-back
+ * is still in flight.  A window ends early at the first update whose word
+ * it already reads; the stream values drawn past that point open the next
+ * window.  Updates from different PEs still race, as in HPCC.
+ */
+double
+NBIRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates)
+{
+  s64Int iterate, nwindow, pending, i;
+  int logTableLocal;
+  u64Int ran, offset;
+  u64Int *slot, *slot_ran, *slot_off;
+  int *slot_pe;
+  RA_Stream_t stream;
+  RA_WindowSet_t seen;
+  double RealTime;
+
+  slot = XMALLOC(u64Int, RA_Window);
+  slot_ran = XMALLOC(u64Int, RA_Window);
+  slot_off = XMALLOC(u64Int, RA_Window);
+  slot_pe = XMALLOC(int, RA_Window);
+  if (! slot || ! slot_ran || ! slot_off || ! slot_pe || window_set_init(&seen, RA_Window)) {
+    fprintf(stderr, "PE%d: failed to allocate update window\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0, pending = 0; iterate < ProcNumUpdates; iterate += nwindow) {
+    nwindow = ProcNumUpdates - iterate;
+    if (nwindow > RA_Window)
+      nwindow = RA_Window;
+
+    RA_StreamFill(&stream, slot_ran + pending, nwindow - pending);
+    seen.current++;
+    for (i = 0; i < nwindow; i++) {
+      ran = slot_ran[i];
+      slot_pe[i] = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                             Remainder, NumProcs, MyProc, &offset);
+      slot_off[i] = offset;
+      if (window_set_insert(&seen, offset * NumProcs + slot_pe[i]))
+        break;
+      shmem_longlong_get_nbi((long long *)&slot[i],
+                             (long long *)&HPCC_Table[offset],
+                             1, slot_pe[i]);
+    }
+    pending = nwindow - i;
+    nwindow = i;
+
+    shmem_quiet();
+
+    for (i = 0; i < nwindow; i++)
+      shmem_longlong_p((long long *)&HPCC_Table[slot_off[i]],
+                       slot[i] ^ slot_ran[i], slot_pe[i]);
+
+    shmem_quiet();
+    memmove(slot_ran, slot_ran + nwindow, pending * sizeof(u64Int));
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  window_set_free(&seen);
+  free(slot_pe);
+  free(slot_off);
+  free(slot_ran);
+  free(slot);
+
+  return RealTime;
+}
+
+/*
+ * Non-blocking fetching AMO engine: keeps RA_Window updates in flight as
+ * shmem_atomic_fetch_xor_nbi into a ring of local result slots, retired
+ * together by a single quiet.  The XOR is atomic at the owner, so unlike
+ * the nbi engine nothing races; the old values fetched are XORed into
+ * RA_Checksum once the window completes.  Libraries older than OpenSHMEM
+ * 1.5 lack the non-blocking form and get the blocking fetch_xor, so the
+ * mode then measures one fetching round trip per update.
+ */
+double
+FetchNBIRandomAccessUpdate(u64Int logTableSize,
+                           u64Int TableSize,
+                           u64Int LocalTableSize,
+                           u64Int MinLocalTableSize,
+                           u64Int GlobalStartMyProc,
+                           u64Int Top,
+                           int logNumProcs,
+                           int NumProcs,
+                           int Remainder,
+                           int MyProc,
+                           s64Int ProcNumUpdates)
+{
+  s64Int iterate, nwindow, i;
+  int logTableLocal, remote_proc;
+  u64Int ran, offset, sum = 0;
+  u64Int *slot, *slot_ran;
+  RA_Stream_t stream;
+  double RealTime;
+
+  slot = XMALLOC(u64Int, RA_Window);
+  slot_ran = XMALLOC(u64Int, RA_Window);
+  if (! slot || ! slot_ran) {
+    fprintf(stderr, "PE%d: failed to allocate update window\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nwindow) {
+    nwindow = ProcNumUpdates - iterate;
+    if (nwindow > RA_Window)
+      nwindow = RA_Window;
+
+    RA_StreamFill(&stream, slot_ran, nwindow);
+    for (i = 0; i < nwindow; i++) {
+      ran = slot_ran[i];
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+#if RA_SHMEM_AT_LEAST(1, 5)
+      shmem_atomic_fetch_xor_nbi(&slot[i], &HPCC_Table[offset], ran, remote_proc);
+#else
+      slot[i] = shmem_atomic_fetch_xor(&HPCC_Table[offset], ran, remote_proc);
+#endif
+    }
+
+#if RA_SHMEM_AT_LEAST(1, 5)
+    shmem_quiet();
+#endif
+
+    for (i = 0; i < nwindow; i++)
+      sum ^= slot[i];
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  RA_Checksum = sum;
+  free(slot_ran);
+  free(slot);
+
+  return RealTime;
+}
+
+/*
+ * Intra-node fast path: PEs whose slice shmem_ptr() can map are updated
+ * with a plain atomic XOR through that pointer, without a library call;
+ * the rest with shmem_atomic_xor as in the amo engine; the pointers are
+ * looked up once in main (RA_PeTable).  The stream is walked twice, once
+ * applying only the on-node updates and once only the off-node ones, so
+ * that the two kinds are reported separately and CPU and NIC atomics never
+ * touch the same word at the same time.  Each block of the stream is split
+ * into the pass's updates untimed, and only their apply loop and the
+ * closing barrier count towards the pass's time, so neither rate pays for
+ * generating and skipping the other kind.  Splitting the whole stream
+ * ahead instead would take several times the table's memory.
+ */
+double
+PtrRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, count, n, i;
+  int logTableLocal, remote_proc, pass;
+  u64Int offset;
+  u64Int block[RA_STREAM_BLOCK], sel_ran[RA_STREAM_BLOCK], sel_off[RA_STREAM_BLOCK];
+  int sel_pe[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+  double t0;
+
+  logTableLocal = logTableSize - logNumProcs;
+
+  for (pass = RA_ON_NODE; pass <= RA_OFF_NODE; pass++) {
+    RA_StreamInit(&stream, 4*GlobalStartMyProc);
+    count = 0;
+    RA_NodeTime[pass] = 0.0;
+
+    shmem_barrier_all();
+    for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+      nblock = ProcNumUpdates - iterate;
+      if (nblock > RA_STREAM_BLOCK)
+        nblock = RA_STREAM_BLOCK;
+      RA_StreamFill(&stream, block, nblock);
+
+      /* Pick this pass's updates out of the block, untimed */
+      for (i = 0, n = 0; i < nblock; i++) {
+        remote_proc = RA_Target(block[i], logTableLocal, TableSize, MinLocalTableSize, Top,
+                                Remainder, NumProcs, MyProc, &offset);
+        if ((RA_PeTable[remote_proc] != NULL) == (pass == RA_ON_NODE)) {
+          sel_ran[n] = block[i];
+          sel_off[n] = offset;
+          sel_pe[n] = remote_proc;
+          n++;
+        }
+      }
+
+      t0 = RTSEC();
+      if (pass == RA_ON_NODE)
+        for (i = 0; i < n; i++)
+          __atomic_fetch_xor(&RA_PeTable[sel_pe[i]][sel_off[i]], sel_ran[i], __ATOMIC_RELAXED);
+      else
+        for (i = 0; i < n; i++)
+          shmem_atomic_xor(&HPCC_Table[sel_off[i]], sel_ran[i], sel_pe[i]);
+      RA_NodeTime[pass] += RTSEC() - t0;
+      count += n;
+    }
+
+    /* The barrier completes the off-node XORs and waits for the slowest PE */
+    t0 = RTSEC();
+    shmem_barrier_all();
+    RA_NodeTime[pass] += RTSEC() - t0;
+    RA_NodeUpdates[pass] = count;
+  }
+
+  return RA_NodeTime[RA_ON_NODE] + RA_NodeTime[RA_OFF_NODE];
+}
+
+/* Apply one update on this node, through shmem_ptr() where it maps */
+static inline void
+RA_Scatter(u64Int **PeTable, int pe, u64Int offset, u64Int datum)
+{
+  if (PeTable[pe])
+    __atomic_fetch_xor(&PeTable[pe][offset], datum, __ATOMIC_RELAXED);
+  else
+    shmem_atomic_xor(&HPCC_Table[offset], datum, pe);
+}
+
+/*
+ * Two-hop engine (conveyor-style routing): the look-ahead window is
+ * bucketed by destination node rather than destination PE, and each bucket
+ * goes in one put to the PE with our node-local rank on that node, which
+ * scatters the updates to its neighbours through shmem_ptr().  With P PEs
+ * on N nodes a PE sends N instead of P messages per window, so they stay
+ * large as the job grows.  Updates for our own node skip the network.
+ *
+ * Nodes are taken to hold RA_PesPerNode consecutive PEs; a shorter last
+ * node is shared out by rank modulo its size.  Mailboxes are indexed by
+ * source PE and double buffered as in the bucketed engine.
+ */
+double
+RouteRandomAccessUpdate(u64Int logTableSize,
+                        u64Int TableSize,
+                        u64Int LocalTableSize,
+                        u64Int MinLocalTableSize,
+                        u64Int GlobalStartMyProc,
+                        u64Int Top,
+                        int logNumProcs,
+                        int NumProcs,
+                        int Remainder,
+                        int MyProc,
+                        s64Int ProcNumUpdates)
+{
+  s64Int iterate, nwindow, i;
+  int logTableLocal, pe, node, owner, buf, nrecv, first, size;
+  int PesPerNode, NumNodes, MyNode;
+  u64Int ran, datum, offset;
+  u64Int *mailbox;          /* [2][NumProcs][LOCAL_BUFFER_SIZE] */
+  long long *recv_count;    /* [2][NumProcs] */
+  long long *nwindows;      /* windows of the busiest PE */
+  long long *pWrk;
+  long *pSync;
+  u64Int **PeTable;
+  int *bucket_count, *bucket_start, *partner;
+  RA_Stream_t stream;
+  double RealTime;
+
+  PesPerNode = RA_PesPerNode;
+  if (PesPerNode < 1 || PesPerNode > NumProcs)
+    PesPerNode = NumProcs;
+  NumNodes = (NumProcs + PesPerNode - 1) / PesPerNode;
+  MyNode = MyProc / PesPerNode;
+
+  mailbox = (u64Int *)shmem_malloc(sizeof(u64Int) * 2 * NumProcs * LOCAL_BUFFER_SIZE);
+  recv_count = (long long *)shmem_malloc(sizeof(long long) * 2 * NumProcs);
+  nwindows = (long long *)shmem_malloc(sizeof(long long) * 2);
+  pWrk = (long long *)shmem_malloc(sizeof(long long) * _SHMEM_REDUCE_MIN_WRKDATA_SIZE);
+  pSync = (long *)shmem_malloc(sizeof(long) * _SHMEM_REDUCE_SYNC_SIZE);
+  PeTable = XMALLOC(u64Int *, NumProcs);
+  bucket_count = XMALLOC(int, NumNodes);
+  bucket_start = XMALLOC(int, NumNodes + 1);
+  partner = XMALLOC(int, NumNodes);
+  if (! mailbox || ! recv_count || ! nwindows || ! pWrk || ! pSync ||
+      ! PeTable || ! bucket_count || ! bucket_start || ! partner) {
+    fprintf(stderr, "PE%d: failed to allocate routing buffers\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  for (i = 0; i < 2 * NumProcs; i++)
+    recv_count[i] = 0;
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i++)
+    pSync[i] = _SHMEM_SYNC_VALUE;
+
+  /* Only our own node is scattered to; the others stay NULL and unused */
+  for (pe = 0; pe < NumProcs; pe++)
+    PeTable[pe] = (pe / PesPerNode == MyNode) ? (u64Int *)shmem_ptr(HPCC_Table, pe) : NULL;
+  for (node = 0; node < NumNodes; node++) {
+    first = node * PesPerNode;
+    size = NumProcs - first < PesPerNode ? NumProcs - first : PesPerNode;
+    partner[node] = first + (MyProc % PesPerNode) % size;
+  }
+
+  nwindows[0] = (ProcNumUpdates + LOCAL_BUFFER_SIZE - 1) / LOCAL_BUFFER_SIZE;
+  shmem_barrier_all();
+  shmem_longlong_max_to_all(&nwindows[1], &nwindows[0], 1, 0, 0, NumProcs, pWrk, pSync);
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0, buf = 0; nwindows[1] > 0; iterate += nwindow, buf ^= 1, nwindows[1]--) {
+    u64Int *inbox = mailbox + (u64Int)buf * NumProcs * LOCAL_BUFFER_SIZE;
+    long long *incount = recv_count + buf * NumProcs;
+    u64Int window[LOCAL_BUFFER_SIZE];
+    int dest[LOCAL_BUFFER_SIZE];
+    int nremote = 0;
+
+    nwindow = ProcNumUpdates - iterate;
+    if (nwindow > LOCAL_BUFFER_SIZE)
+      nwindow = LOCAL_BUFFER_SIZE;
+    if (nwindow < 0)
+      nwindow = 0;
+
+    /* Generate the window: scatter on-node updates, count the rest per node */
+    for (node = 0; node < NumNodes; node++)
+      bucket_count[node] = 0;
+    RA_StreamFill(&stream, window, nwindow);
+    for (i = 0; i < nwindow; i++) {
+      ran = window[i];
+      pe = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                     Remainder, NumProcs, MyProc, &offset);
+      node = pe / PesPerNode;
+      if (node == MyNode) {
+        RA_Scatter(PeTable, pe, offset, ran);
+        continue;
+      }
+      window[nremote] = ran;   /* compacted in place, nremote <= i */
+      dest[nremote++] = node;
+      bucket_count[node]++;
+    }
+
+    /* Counting sort into LocalSendBuffer */
+    bucket_start[0] = 0;
+    for (node = 0; node < NumNodes; node++)
+      bucket_start[node+1] = bucket_start[node] + bucket_count[node];
+    for (i = 0; i < nremote; i++)
+      LocalSendBuffer[bucket_start[dest[i]]++] = window[i];
+
+    /* One bulk put per destination node, to our partner there */
+    for (node = 0; node < NumNodes; node++) {
+      if (bucket_count[node] == 0)
+        continue;
+      shmem_longlong_put_nbi((long long *)&inbox[(u64Int)MyProc * LOCAL_BUFFER_SIZE],
+                             (long long *)&LocalSendBuffer[bucket_start[node] - bucket_count[node]],
+                             bucket_count[node], partner[node]);
+      shmem_longlong_p(&incount[MyProc], bucket_count[node], partner[node]);
+    }
+
+    /* Completes all puts of this window on every PE */
+    shmem_barrier_all();
+
+    /* Second hop: scatter what other nodes routed through us */
+    for (pe = 0; pe < NumProcs; pe++) {
+      nrecv = incount[pe];
+      if (nrecv == 0)
+        continue;
+      for (i = 0; i < nrecv; i++) {
+        datum = inbox[(u64Int)pe * LOCAL_BUFFER_SIZE + i];
+        owner = RA_Owner(datum, logTableLocal, TableSize, MinLocalTableSize, Top,
+                         Remainder, &offset);
+        /* An owner off this node issued the update itself and RA_Target
+         * redirected it to the next PE, which is on this node */
+        if (owner / PesPerNode != MyNode)
+          owner = RA_Target(datum, logTableLocal, TableSize, MinLocalTableSize, Top,
+                            Remainder, NumProcs, owner, &offset);
+        RA_Scatter(PeTable, owner, offset, datum);
+      }
+      incount[pe] = 0;
+    }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  free(partner);
+  free(bucket_start);
+  free(bucket_count);
+  free(PeTable);
+  shmem_free(pSync);
+  shmem_free(pWrk);
+  shmem_free(nwindows);
+  shmem_free(recv_count);
+  shmem_free(mailbox);
+
+  return RealTime;
+}
+
+/*
+ * Local pass: every PE applies its stream to its own slice of HPCC_Table
+ * with plain loads and stores, as HPCC's SingleRandomAccess does.  This is
+ * the memory-system side of the table-size sweep and of the local mode and
+ * involves no communication between the barriers.
+ */
+double
+LocalRandomAccessUpdate(u64Int logTableSize,
+                        u64Int TableSize,
+                        u64Int LocalTableSize,
+                        u64Int MinLocalTableSize,
+                        u64Int GlobalStartMyProc,
+                        u64Int Top,
+                        int logNumProcs,
+                        int NumProcs,
+                        int Remainder,
+                        int MyProc,
+                        s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, i;
+  u64Int ran;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+  double RealTime;
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+    nblock = ProcNumUpdates - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++) {
+      ran = block[i];
+      HPCC_Table[Remainder ? (ran & (TableSize-1)) % LocalTableSize
+                           : ran & (LocalTableSize-1)] ^= ran;
+    }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  return RealTime;
+}
+
+/*
+ * Local pass with software prefetch: the addresses of a block are computed
+ * ahead of the XORs, and the word RA_Prefetch updates ahead is prefetched
+ * for writing before the current one is applied, so up to RA_Prefetch
+ * cache misses overlap instead of one at a time.
+ */
+double
+PrefetchRandomAccessUpdate(u64Int logTableSize,
+                           u64Int TableSize,
+                           u64Int LocalTableSize,
+                           u64Int MinLocalTableSize,
+                           u64Int GlobalStartMyProc,
+                           u64Int Top,
+                           int logNumProcs,
+                           int NumProcs,
+                           int Remainder,
+                           int MyProc,
+                           s64Int ProcNumUpdates)
+{
+  s64Int iterate, nblock, i, ahead;
+  u64Int ran;
+  u64Int block[RA_STREAM_BLOCK];
+  u64Int *index[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+  double RealTime;
+
+  RA_StreamInit(&stream, 4*GlobalStartMyProc);
+  ahead = RA_Prefetch < RA_STREAM_BLOCK ? RA_Prefetch : RA_STREAM_BLOCK;
+
+  shmem_barrier_all();
+  /* Begin timed section */
+  RealTime = -RTSEC();
+  for (iterate = 0; iterate < ProcNumUpdates; iterate += nblock) {
+    nblock = ProcNumUpdates - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++) {
+      ran = block[i];
+      index[i] = &HPCC_Table[Remainder ? (ran & (TableSize-1)) % LocalTableSize
+                                       : ran & (LocalTableSize-1)];
+    }
+
+    for (i = 0; i < ahead && i < nblock; i++)
+      __builtin_prefetch(index[i], 1, 0);
+    for (i = 0; i < nblock; i++) {
+      if (i + ahead < nblock)
+        __builtin_prefetch(index[i + ahead], 1, 0);
+      *index[i] ^= block[i];
+    }
+  }
+
+  shmem_barrier_all();
+  /* End timed section */
+  RealTime += RTSEC();
+
+  return RealTime;
+}
@@ -22,6 +22,23 @@ static double RTSEC()
 
 extern s64Int starts (u64Int);
 
+/*
+ * Batched stream generator: RA_STREAM_LANES interleaved copies of the
+ * stream advanced together in SIMD lanes where the target has them.
+ * RA_StreamFill() returns the same elements, in the same order, as the
+ * scalar ran = (ran << 1) ^ ... loop started from starts(n).
+ */
+#define RA_STREAM_LANES 8
+#define RA_STREAM_BLOCK 1024  /* elements generated ahead of an update loop */
+typedef struct {
+  u64Int lane[RA_STREAM_LANES];   /* next element of each lane */
+  u64Int spare[RA_STREAM_LANES];  /* row split by the last fill */
+  int nspare;                     /* elements of spare[] not handed out */
+} RA_Stream_t;
+
+extern void RA_StreamInit(RA_Stream_t *s, u64Int n);
+extern void RA_StreamFill(RA_Stream_t *s, u64Int *buf, s64Int count);
+
 #define WANT_MPI2_TEST 0
 
 
@@ -33,6 +50,15 @@ extern s64Int starts (u64Int);
 #define UPDATE_TAG   2
 #define USE_NONBLOCKING_SEND 1
 
+/* Table sizing defaults (see -n, -f and -u) */
+#define RA_DEFAULT_PE_MEM 20000000
+#define RA_DEFAULT_UPDATES_PER_ENTRY 4
+
+/* Time-bounded runs (-t): each mode is first timed on 1/RA_TIME_BOUND_SAMPLE
+ * of its updates; building with -DRA_TIME_BOUND makes the bound the default */
+#define RA_DEFAULT_TIME_BOUND 60.0
+#define RA_TIME_BOUND_SAMPLE 100
+
 #define MAX_TOTAL_PENDING_UPDATES 1024
 #define LOCAL_BUFFER_SIZE MAX_TOTAL_PENDING_UPDATES
 
@@ -62,3 +88,163 @@ Power2NodesRandomAccessUpdate(u64Int logTableSize,
                                  int MyProc,
                                  s64Int ProcNumUpdates);
 
+/* Update engines (selected with -m) */
+#define RA_MODE_GETPUT   0   /* blocking get/xor/put + quiet per update */
+#define RA_MODE_AMO      1   /* one remote shmem_ctx atomic xor per update */
+#define RA_MODE_NBI      2   /* RA_Window get_nbi in flight, one quiet per window */
+#define RA_NUM_MODES     3
+
+typedef double (*RandomAccessUpdate_t)(u64Int logTableSize,
+                                       u64Int TableSize,
+                                       u64Int LocalTableSize,
+                                       u64Int MinLocalTableSize,
+                                       u64Int GlobalStartMyProc,
+                                       u64Int Top,
+                                       int logNumProcs,
+                                       int NumProcs,
+                                       int Remainder,
+                                       int MyProc,
+                                       s64Int ProcNumUpdates);
+
+extern double
+GetPutRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates);
+
+extern double
+AMORandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates);
+
+extern double
+NBIRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates);
+
+/* Updates in flight per window for the nbi engine (-w) */
+#define RA_DEFAULT_WINDOW 64
+extern int RA_Window;
+
+/*
+ * Context-sharing policies (-c).  RA_CTX_PRIVATE and RA_CTX_SERIALIZED give
+ * every thread a context of its own created with that option, RA_CTX_SHARED
+ * puts all threads on SHMEM_CTX_DEFAULT, and RA_CTX_POOL creates RA_CtxPool
+ * contexts with default options that thread t shares as context
+ * t % RA_CtxPool (0: one per thread).  Contexts that cannot be created are
+ * replaced by SHMEM_CTX_DEFAULT and counted in RA_CtxFallback.
+ */
+#define RA_CTX_PRIVATE    0
+#define RA_CTX_SERIALIZED 1
+#define RA_CTX_SHARED     2
+#define RA_CTX_POOL       3
+extern int RA_CtxPolicy;
+extern int RA_CtxPool;
+extern int RA_CtxFallback;
+
+/* Error check: returns the number of local table words that differ from
+ * their initial value after the update stream has been applied twice */
+extern s64Int
+RandomAccessCheck(u64Int logTableSize,
+                  u64Int TableSize,
+                  u64Int LocalTableSize,
+                  u64Int MinLocalTableSize,
+                  u64Int GlobalStartMyProc,
+                  u64Int Top,
+                  int logNumProcs,
+                  int NumProcs,
+                  int Remainder,
+                  int MyProc,
+                  s64Int ProcNumUpdates);
+
+/* Time each thread spent in its update loop during the last run */
+extern double RA_ThreadTime[];
+
+/* Contiguous share [*first, *last) of n updates for thread tid */
+static inline void
+RA_ThreadShare(s64Int n, int tid, int nthreads, s64Int *first, s64Int *last)
+{
+  *first = n / nthreads * tid + (tid < n % nthreads ? tid : n % nthreads);
+  *last = *first + n / nthreads + (tid < n % nthreads ? 1 : 0);
+}
+
+/* Words held by pe: the first Remainder PEs hold one extra word */
+static inline u64Int
+RA_LocalSize(int pe, u64Int MinLocalTableSize, int Remainder)
+{
+  return pe < Remainder ? MinLocalTableSize + 1 : MinLocalTableSize;
+}
+
+/*
+ * Owner and local offset of the word addressed by ran in the HPCC block
+ * distribution: the Top words of the table live on the first Remainder
+ * PEs (MinLocalTableSize + 1 words each), the rest on the other PEs
+ * (MinLocalTableSize words each).  With a power-of-two PE count Remainder
+ * is 0 and this reduces to a shift and a mask.
+ */
+static inline int
+RA_Owner(u64Int ran, int logTableLocal, u64Int TableSize,
+         u64Int MinLocalTableSize, u64Int Top, int Remainder, u64Int *offset)
+{
+  u64Int GlobalOffset = ran & (TableSize - 1);
+  int pe;
+
+  if (Remainder == 0) {
+    *offset = GlobalOffset & (MinLocalTableSize - 1);
+    return GlobalOffset >> logTableLocal;
+  }
+  if (GlobalOffset < Top) {
+    pe = GlobalOffset / (MinLocalTableSize + 1);
+    *offset = GlobalOffset - pe * (MinLocalTableSize + 1);
+  }
+  else {
+    pe = (GlobalOffset - Remainder) / MinLocalTableSize;
+    *offset = GlobalOffset - (pe * MinLocalTableSize + Remainder);
+  }
+  return pe;
+}
+
+/*
+ * Target of an update: the owner of the word, except that updates this PE
+ * would make to itself go to the next PE instead, so that all updates are
+ * remote.  The offset wraps if that PE holds one word less.
+ */
+static inline int
+RA_Target(u64Int ran, int logTableLocal, u64Int TableSize,
+          u64Int MinLocalTableSize, u64Int Top, int Remainder,
+          int NumProcs, int MyProc, u64Int *offset)
+{
+  int pe = RA_Owner(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                    Remainder, offset);
+
+  if (pe == MyProc && NumProcs > 1) {
+    pe = (pe + 1) % NumProcs;
+    if (*offset >= RA_LocalSize(pe, MinLocalTableSize, Remainder))
+      *offset -= RA_LocalSize(pe, MinLocalTableSize, Remainder);
+  }
+  return pe;
+}
+
@@ -47,9 +47,12 @@ LICENSE for more details.
  *
  */
 
+#define _GNU_SOURCE
 #include <sched.h>
 #include <hpcc.h>
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 #include "RandomAccess.h"
 #include <shmem.h>
 #define MAXTHREADS 256
@@ -71,6 +74,219 @@ u64Int targetBuf[sizeof(srcBuf) / sizeof(u64Int)];
 /* Allocate main table (in global memory) */
 u64Int *HPCC_Table;
 
+/* Time each thread spent in its update loop during the last run */
+double RA_ThreadTime[MAXTHREADS];
+
+static const char *ModeName[RA_NUM_MODES] = {
+  "getput",
+  "amo",
+  "nbi"
+};
+
+static RandomAccessUpdate_t UpdateEngine[RA_NUM_MODES] = {
+  GetPutRandomAccessUpdate,
+  AMORandomAccessUpdate,
+  NBIRandomAccessUpdate
+};
+
+/* Window depths to run the nbi engine with (-w) */
+#define RA_MAX_WINDOWS 16
+int RA_Window = RA_DEFAULT_WINDOW;
+static int Windows[RA_MAX_WINDOWS] = { RA_DEFAULT_WINDOW };
+static int NumWindows = 1;
+
+/* Context-sharing policies to run every engine with (-c) */
+#define RA_MAX_POLICIES 16
+int RA_CtxPolicy = RA_CTX_POOL;
+int RA_CtxPool = 0;
+int RA_CtxFallback;
+static int CtxPolicies[RA_MAX_POLICIES] = { RA_CTX_POOL };
+static int CtxPools[RA_MAX_POLICIES] = { 0 };
+static int NumPolicies = 1;
+
+/* One row of the summary table per timed run */
+#define RA_MAX_RUNS ((RA_NUM_MODES + RA_MAX_WINDOWS) * RA_MAX_POLICIES)
+typedef struct {
+  char name[32];
+  double time;
+  double updates;           /* performed, fewer than NumUpdates if time bound */
+  s64Int errors;
+} RA_Run_t;
+
+static void
+usage(char *prog)
+{
+  int mode;
+
+  fprintf(stderr, "Usage: %s [-m mode[,mode...]] [-w depth[,depth...]|sweep] [-c policy[,policy...]|sweep]\n"
+                  "          [-n log2_words_per_PE | -f mem_fraction] [-u updates_per_entry] [-t seconds] [-v] [-h]\n", prog);
+  fprintf(stderr, "  -m  update modes to run, or 'all' (default: getput)\n");
+  fprintf(stderr, "      available:");
+  for (mode = 0; mode < RA_NUM_MODES; mode++)
+    fprintf(stderr, " %s", ModeName[mode]);
+  fprintf(stderr, "\n");
+  fprintf(stderr, "  -w  updates in flight for the nbi mode, 1..%d, or 'sweep'\n"
+                  "      for all powers of two (default: %d)\n",
+          MAX_TOTAL_PENDING_UPDATES, RA_DEFAULT_WINDOW);
+  fprintf(stderr, "  -c  shmem contexts of the threads: 'private' or 'serialized' (one\n"
+                  "      per thread, created with that option), 'shared' (all threads on\n"
+                  "      SHMEM_CTX_DEFAULT) or N (N contexts shared round-robin by the\n"
+                  "      threads); 'sweep' runs all of them with N = 1, 2, 4 .. threads\n"
+                  "      (default: one context per thread)\n");
+  fprintf(stderr, "  -n  table size as log2 of the words per PE (env GUPS_LOG_LOCAL_SIZE)\n");
+  fprintf(stderr, "  -f  table size as a fraction of the node's physical memory,\n"
+                  "      shared by the PEs on the node (env GUPS_MEM_FRACTION)\n");
+  fprintf(stderr, "      default without -n/-f: %d bytes per PE\n", RA_DEFAULT_PE_MEM);
+  fprintf(stderr, "  -u  updates per table entry (env GUPS_UPDATES_PER_ENTRY, default %d)\n",
+          RA_DEFAULT_UPDATES_PER_ENTRY);
+  fprintf(stderr, "  -t  time bound in seconds per mode: a short calibration run sets\n"
+                  "      the update count (env GUPS_TIME_BOUND, 0 for none)\n");
+  fprintf(stderr, "  -v  count table errors after each mode (HPCC check)\n");
+}
+
+/* Physical memory of this node in bytes, 0 if it cannot be determined */
+static double
+node_memory(void)
+{
+  FILE *f;
+  char line[256];
+  double kb = 0;
+
+  if ((f = fopen("/proc/meminfo", "r")) != NULL) {
+    while (fgets(line, sizeof(line), f))
+      if (sscanf(line, "MemTotal: %lf kB", &kb) == 1)
+        break;
+    fclose(f);
+  }
+  if (kb > 0)
+    return kb * 1024;
+
+#if defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+  return (double) sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE);
+#else
+  return 0;
+#endif
+}
+
+/*
+ * Number of PEs sharing this node: those whose copy of the symmetric
+ * object sym is directly addressable.  GUPS_PES_PER_NODE overrides this
+ * for libraries whose shmem_ptr() only ever returns the local address.
+ */
+static int
+node_pes(void *sym, int NumProcs)
+{
+  int pe, n = 0;
+  char *env;
+
+  if ((env = getenv("GUPS_PES_PER_NODE")) != NULL && atoi(env) > 0)
+    return atoi(env);
+
+  for (pe = 0; pe < NumProcs; pe++)
+    if (shmem_ptr(sym, pe) != NULL)
+      n++;
+  return n > 0 ? n : 1;
+}
+
+/* Parse a comma separated list of window depths into Windows[] */
+static int
+parse_windows(char *list)
+{
+  int depth;
+  char *tok;
+
+  NumWindows = 0;
+  if (0 == strcmp(list, "sweep")) {
+    for (depth = 1; depth <= MAX_TOTAL_PENDING_UPDATES; depth <<= 1)
+      Windows[NumWindows++] = depth;
+    return NumWindows;
+  }
+  for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+    depth = atoi(tok);
+    /* HPCC limits the look-ahead to MAX_TOTAL_PENDING_UPDATES */
+    if (depth < 1 || depth > MAX_TOTAL_PENDING_UPDATES || NumWindows == RA_MAX_WINDOWS)
+      return -1;
+    Windows[NumWindows++] = depth;
+  }
+  return NumWindows;
+}
+
+/* Parse a comma separated list of context policies, nt threads per PE */
+static int
+parse_contexts(char *list, int nt)
+{
+  int n;
+  char *tok;
+
+  NumPolicies = 0;
+  if (0 == strcmp(list, "sweep")) {
+    CtxPolicies[NumPolicies] = RA_CTX_PRIVATE;
+    CtxPools[NumPolicies++] = 0;
+    CtxPolicies[NumPolicies] = RA_CTX_SERIALIZED;
+    CtxPools[NumPolicies++] = 0;
+    CtxPolicies[NumPolicies] = RA_CTX_SHARED;
+    CtxPools[NumPolicies++] = 0;
+    for (n = 1; n < nt && NumPolicies < RA_MAX_POLICIES - 1; n <<= 1) {
+      CtxPolicies[NumPolicies] = RA_CTX_POOL;
+      CtxPools[NumPolicies++] = n;
+    }
+    CtxPolicies[NumPolicies] = RA_CTX_POOL;
+    CtxPools[NumPolicies++] = nt;
+    return NumPolicies;
+  }
+  for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+    if (NumPolicies == RA_MAX_POLICIES)
+      return -1;
+    CtxPools[NumPolicies] = 0;
+    if (0 == strcmp(tok, "private"))
+      CtxPolicies[NumPolicies] = RA_CTX_PRIVATE;
+    else if (0 == strcmp(tok, "serialized"))
+      CtxPolicies[NumPolicies] = RA_CTX_SERIALIZED;
+    else if (0 == strcmp(tok, "shared"))
+      CtxPolicies[NumPolicies] = RA_CTX_SHARED;
+    else if ((n = atoi(tok)) > 0) {
+      CtxPolicies[NumPolicies] = RA_CTX_POOL;
+      CtxPools[NumPolicies] = n < nt ? n : nt;
+    }
+    else
+      return -1;
+    NumPolicies++;
+  }
+  return NumPolicies;
+}
+
+/* Short name of context policy p for the run names */
+static void
+context_name(char *buf, size_t len, int p, int nt)
+{
+  static const char *name[] = { "private", "serialized", "shared" };
+
+  if (CtxPolicies[p] == RA_CTX_POOL)
+    snprintf(buf, len, "ctx%d", CtxPools[p] > 0 ? CtxPools[p] : nt);
+  else
+    snprintf(buf, len, "%s", name[CtxPolicies[p]]);
+}
+
+/* Parse a comma separated list of mode names into a bit mask */
+static int
+parse_modes(char *list)
+{
+  int mask = 0, mode;
+  char *tok;
+
+  for (tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+    if (0 == strcmp(tok, "all"))
+      return (1 << RA_NUM_MODES) - 1;
+    for (mode = 0; mode < RA_NUM_MODES; mode++)
+      if (0 == strcmp(tok, ModeName[mode]))
+        break;
+    if (mode == RA_NUM_MODES)
+      return -1;
+    mask |= 1 << mode;
+  }
+  return mask;
+}
+
 int main(int argc, char **argv)
 {
   int debug = 0;
@@ -82,6 +298,7 @@ int main(int argc, char **argv)
   s64Int LocalTableSize;    /* Local table width */
   u64Int MinLocalTableSize; /* Integer ratio TableSize/NumProcs */
   u64Int logTableSize, TableSize;
+  int Remainder;            /* Number of processors with (LocalTableSize + 1) entries */
 
   double CPUTime;               /* CPU  time to update table */
   double RealTime;              /* Real time to update table */
@@ -95,9 +312,9 @@ int main(int argc, char **argv)
                        * NumUpdates_Default due to execution time bounds */
   s64Int ProcNumUpdates; /* number of updates per processor */
   s64Int *NumErrors, *GlbNumErrors;
-#ifdef RA_TIME_BOUND
-  s64Int GlbNumUpdates;  /* for reduction */
-#endif
+  s64Int RunNumUpdates;  /* updates per processor in the timed run */
+  s64Int CalNumUpdates;  /* updates per processor in the time-bound calibration */
+  s64Int *ProcBound, *GlbNumUpdates;  /* for reduction */
 
   long *llpSync;
   long long *llpWrk;
@@ -110,42 +327,121 @@ int main(int argc, char **argv)
   double *temp_GUPs;
 
 
-  int nt, tid;
+  int nt, provided;
   int *sAbort, *rAbort;
-
-  int j,k;
-  int logTableLocal,iterate,niterate;
-  int nlocalm1;
-  u64Int datum,procmask;
-  int remote_proc, offset;
-  s64Int remotecount;
-  s64Int *count;
-  s64Int *all_updates;
-  s64Int ran;
-
-  shmem_init();
+  int ModeMask = 1 << RA_MODE_GETPUT;
+  int CheckErrors = 0;
+  int LogLocalSize = -1;         /* -n: log2 words per PE */
+  double MemFraction = 0;        /* -f: fraction of node memory */
+  int UpdatesPerEntry = RA_DEFAULT_UPDATES_PER_ENTRY;
+  double NodeMem = 0;
+  int NodePEs = 1;
+  char *env;
+  int c;
+
+  shmem_init_thread(SHMEM_THREAD_MULTIPLE, &provided);
+  if (provided != SHMEM_THREAD_MULTIPLE) {
+    if (0 == shmem_my_pe())
+      fprintf(stderr, "SHMEM_THREAD_MULTIPLE is not supported by this OpenSHMEM library\n");
+    shmem_global_exit(1);
+  }
 
 #pragma omp parallel
 {
   nt = omp_get_num_threads();
 }
+  if (nt > MAXTHREADS) {
+    if (0 == shmem_my_pe())
+      fprintf(stderr, "At most %d threads per PE are supported\n", MAXTHREADS);
+    shmem_global_exit(1);
+  }
+
+  /* Environment first, command line options override it */
+  if ((env = getenv("GUPS_LOG_LOCAL_SIZE")) != NULL)
+    LogLocalSize = atoi(env);
+  if ((env = getenv("GUPS_MEM_FRACTION")) != NULL)
+    MemFraction = atof(env);
+  if ((env = getenv("GUPS_UPDATES_PER_ENTRY")) != NULL)
+    UpdatesPerEntry = atoi(env);
+#ifdef RA_TIME_BOUND
+  timeBound = RA_DEFAULT_TIME_BOUND;
+#endif
+  if ((env = getenv("GUPS_TIME_BOUND")) != NULL)
+    timeBound = atof(env);
+
+  while ((c = getopt(argc, argv, "m:w:c:n:f:u:t:vh")) != -1)
+    switch (c) {
+    case 'm':
+      ModeMask = parse_modes(optarg);
+      if (ModeMask <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'w':
+      if (parse_windows(optarg) <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'c':
+      if (parse_contexts(optarg, nt) <= 0) {
+        if (0 == shmem_my_pe()) usage(argv[0]);
+        shmem_finalize();
+        return 1;
+      }
+      break;
+    case 'n':
+      LogLocalSize = atoi(optarg);
+      MemFraction = 0;
+      break;
+    case 'f':
+      MemFraction = atof(optarg);
+      LogLocalSize = -1;
+      break;
+    case 'u':
+      UpdatesPerEntry = atoi(optarg);
+      break;
+    case 't':
+      timeBound = atof(optarg);
+      break;
+    case 'v':
+      CheckErrors = 1;
+      break;
+    case 'h':
+    default:
+      if (0 == shmem_my_pe()) usage(argv[0]);
+      shmem_finalize();
+      return 'h' == c ? 0 : 1;
+    }
+
+  if (LogLocalSize > 40 || MemFraction < 0 || MemFraction > 1 || UpdatesPerEntry < 1) {
+    if (0 == shmem_my_pe()) usage(argv[0]);
+    shmem_finalize();
+    return 1;
+  }
+
   /*Allocate symmetric memory*/
   sAbort = (int *)shmem_malloc(sizeof(int));
   rAbort = (int *)shmem_malloc(sizeof(int));
-  llpSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_BCAST_SYNC_SIZE);
+  llpSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_REDUCE_SYNC_SIZE);
   llpWrk = (long long *)shmem_malloc(sizeof(long long) * _SHMEM_REDUCE_SYNC_SIZE);
-  ipSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_BCAST_SYNC_SIZE);
+  ipSync = (long *)shmem_malloc(sizeof(long) *_SHMEM_REDUCE_SYNC_SIZE);
   ipWrk = (int *)shmem_malloc(sizeof(int) * _SHMEM_REDUCE_SYNC_SIZE);
 
   GUPs = (double *)shmem_malloc(sizeof(double));
   temp_GUPs = (double *)shmem_malloc(sizeof(double));
   GlbNumErrors = (s64Int *)shmem_malloc(sizeof(s64Int));
   NumErrors = (s64Int *)shmem_malloc(sizeof(s64Int));
+  ProcBound = (s64Int *)shmem_malloc(sizeof(s64Int));
+  GlbNumUpdates = (s64Int *)shmem_malloc(sizeof(s64Int));
 
   *GlbNumErrors = 0;
   *NumErrors = 0;
 
-  for (i = 0; i < _SHMEM_BCAST_SYNC_SIZE; i += 1){
+  for (i = 0; i < _SHMEM_REDUCE_SYNC_SIZE; i += 1){
         ipSync[i] = _SHMEM_SYNC_VALUE;
         llpSync[i] = _SHMEM_SYNC_VALUE;
   }
@@ -160,7 +456,20 @@ int main(int argc, char **argv)
     setbuf(outFile, NULL);
   }
 
-  TotalMem = 20000000; /* max single node memory */
+  if (LogLocalSize >= 0)
+    TotalMem = ldexp(1.0, LogLocalSize) * sizeof(u64Int);
+  else if (MemFraction > 0) {
+    NodeMem = node_memory();
+    NodePEs = node_pes(sAbort, NumProcs);
+    TotalMem = MemFraction * NodeMem / NodePEs;
+    if (TotalMem < sizeof(u64Int)) {
+      if (MyProc == 0) fprintf(outFile, "Cannot determine node memory, using the default table size.\n");
+      TotalMem = RA_DEFAULT_PE_MEM;
+      MemFraction = 0;
+    }
+  }
+  else
+    TotalMem = RA_DEFAULT_PE_MEM; /* max single node memory */
   TotalMem *= NumProcs;             /* max memory in NumProcs nodes */
 
   TotalMem /= sizeof(u64Int);
@@ -172,14 +481,31 @@ int main(int argc, char **argv)
     ; /* EMPTY */
 
 
+  for (i = 1, logNumProcs = 0; ; logNumProcs++, i <<= 1) {
+    if (i == NumProcs) {
+      PowerofTwo = HPCC_TRUE;
+      break;
+    }
+    if (i > NumProcs) {
+      PowerofTwo = HPCC_FALSE;
+      break;
+    }
+  }
+
+  /* As in HPCC, the first Remainder PEs hold one extra word */
   MinLocalTableSize = (TableSize / NumProcs);
-  LocalTableSize = MinLocalTableSize;
-  GlobalStartMyProc = (MinLocalTableSize * MyProc);
+  Remainder = TableSize - MinLocalTableSize * NumProcs;
+  Top = (MinLocalTableSize + 1) * Remainder;
+  LocalTableSize = RA_LocalSize(MyProc, MinLocalTableSize, Remainder);
+  if (MyProc < Remainder)
+    GlobalStartMyProc = (MinLocalTableSize + 1) * MyProc;
+  else
+    GlobalStartMyProc = MinLocalTableSize * MyProc + Remainder;
 
   *sAbort = 0;
 
-  /*Shmalloc HPCC_Table for RMA*/
-  HPCC_Table = (u64Int *)shmem_malloc( sizeof(u64Int)*LocalTableSize );
+  /*Shmalloc HPCC_Table for RMA; the size must match on every PE*/
+  HPCC_Table = (u64Int *)shmem_malloc( sizeof(u64Int)*(MinLocalTableSize + (Remainder > 0)) );
   if (! HPCC_Table) *sAbort = 1;
 
 
@@ -190,17 +516,17 @@ int main(int argc, char **argv)
   if (*rAbort > 0) {
     if (MyProc == 0) fprintf(outFile, "Failed to allocate memory for the main table.\n");
     /* check all allocations in case there are new added and their order changes */
-    if (HPCC_Table) HPCC_free( HPCC_Table );
+    if (HPCC_Table) shmem_free( HPCC_Table );
     goto failed_table;
   }
 
   /* Default number of global updates to table: 4x number of table entries */
   NumUpdates_Default = 4 * TableSize;
-  ProcNumUpdates = 4*LocalTableSize;
-  NumUpdates = NumUpdates_Default;
+  ProcNumUpdates = (s64Int) UpdatesPerEntry * LocalTableSize;
+  NumUpdates = (u64Int) UpdatesPerEntry * TableSize;
 
   if (MyProc == 0) {
-    fprintf( outFile, "Running on %d processors%s\n", NumProcs, PowerofTwo ? " (PowerofTwo)" : "");
+    fprintf( outFile, "Running on %d processors%s with %d threads/PE\n", NumProcs, PowerofTwo ? " (PowerofTwo)" : "", nt);
     fprintf( outFile, "Total Main table size = 2^" FSTR64 " = " FSTR64 " words\n",logTableSize, TableSize );
     if (PowerofTwo)
         fprintf( outFile, "PE Main table size = 2^" FSTR64 " = " FSTR64 " words/PE\n",
@@ -209,7 +535,13 @@ int main(int argc, char **argv)
         fprintf( outFile, "PE Main table size = (2^" FSTR64 ")/%d  = " FSTR64 " words/PE MAX\n",
                  logTableSize, NumProcs, LocalTableSize);
 
-    fprintf( outFile, "Default number of updates (RECOMMENDED) = " FSTR64 "\tand actually done = %d\n", NumUpdates_Default,ProcNumUpdates*NumProcs);
+    fprintf( outFile, "PE table footprint = " FSTR64 " bytes (%.2f MiB)\n",
+             LocalTableSize * (s64Int) sizeof(u64Int),
+             LocalTableSize * sizeof(u64Int) / 1048576.0 );
+    if (MemFraction > 0)
+      fprintf( outFile, "Node memory = %.2f GiB shared by %d PEs, fraction used = %.3f\n",
+               NodeMem / 1073741824.0, NodePEs, MemFraction );
+    fprintf( outFile, "Default number of updates (RECOMMENDED) = " FSTR64 "\tand actually done = " FSTR64 "\n", NumUpdates_Default,NumUpdates);
   }
 
   /* Initialize main table */
@@ -218,108 +550,175 @@ int main(int argc, char **argv)
 
   shmem_barrier_all();
 
+  int j, mode, variant, nvariants, policy;
+  char ctxname[16];
+  double *ThreadRate, *ThreadStat, *dWrk;
+  RA_Run_t Runs[RA_MAX_RUNS], *run;
+  int NumRuns = 0;
+
+  ThreadRate = (double *) shmem_malloc(sizeof(double) * nt);
+  ThreadStat = (double *) shmem_malloc(sizeof(double) * 3 * nt);/* min, max, sum over PEs */
+  dWrk = (double *) shmem_malloc(sizeof(double) * (nt/2 + 1 + _SHMEM_REDUCE_MIN_WRKDATA_SIZE));
+
+  for (mode = 0; mode < RA_NUM_MODES; mode++) {
+    if (! (ModeMask & (1 << mode)))
+      continue;
+
+    /* Every engine is run once per context policy, the nbi engine once
+     * per requested window depth as well */
+    nvariants = (mode == RA_MODE_NBI) ? NumWindows : 1;
+    for (policy = 0; policy < NumPolicies; policy++)
+    for (variant = 0; variant < nvariants; variant++) {
+      run = &Runs[NumRuns++];
+      RA_CtxPolicy = CtxPolicies[policy];
+      RA_CtxPool = CtxPools[policy];
+      context_name(ctxname, sizeof(ctxname), policy, nt);
+      if (mode == RA_MODE_NBI) {
+        RA_Window = Windows[variant];
+        snprintf(run->name, sizeof(run->name), "%s/%d", ModeName[mode], RA_Window);
+      }
+      else
+        snprintf(run->name, sizeof(run->name), "%s", ModeName[mode]);
+      if (NumPolicies > 1)
+        snprintf(run->name + strlen(run->name), sizeof(run->name) - strlen(run->name),
+                 "/%s", ctxname);
+
+      /* Every engine starts from the same initial table */
+      for (i=0; i<LocalTableSize; i++)
+        HPCC_Table[i] = MyProc;
+      shmem_barrier_all();
+
+      /* HPCC time bound: time a short batch, then run as many updates as
+       * the slowest PE fits in timeBound seconds (never more than the
+       * full run) */
+      RunNumUpdates = ProcNumUpdates;
+      if (timeBound > 0) {
+        CalNumUpdates = ProcNumUpdates / RA_TIME_BOUND_SAMPLE;
+        if (CalNumUpdates < LOCAL_BUFFER_SIZE)
+          CalNumUpdates = ProcNumUpdates < LOCAL_BUFFER_SIZE ? ProcNumUpdates : LOCAL_BUFFER_SIZE;
+        RealTime = UpdateEngine[mode](logTableSize, TableSize, LocalTableSize,
+                                      MinLocalTableSize, GlobalStartMyProc, Top,
+                                      logNumProcs, NumProcs, Remainder, MyProc,
+                                      CalNumUpdates);
+        *ProcBound = RealTime > 0 ? (s64Int) (CalNumUpdates * timeBound / RealTime) : ProcNumUpdates;
+        if (*ProcBound < 1)
+          *ProcBound = 1;
+        shmem_longlong_min_to_all((long long *)GlbNumUpdates, (long long *)ProcBound,
+                                  1, 0,0, NumProcs, llpWrk, llpSync);
+        if (*GlbNumUpdates < RunNumUpdates)
+          RunNumUpdates = *GlbNumUpdates;
+
+        for (i=0; i<LocalTableSize; i++)
+          HPCC_Table[i] = MyProc;
+        shmem_barrier_all();
+      }
 
+      RA_CtxFallback = 0;
+      RealTime = UpdateEngine[mode](logTableSize, TableSize, LocalTableSize,
+                                    MinLocalTableSize, GlobalStartMyProc, Top,
+                                    logNumProcs, NumProcs, Remainder, MyProc,
+                                    RunNumUpdates);
+      run->time = RealTime;
+      run->errors = 0;
+
+      /* Updates actually performed, summed over the PEs */
+      *ProcBound = RunNumUpdates;
+      shmem_longlong_sum_to_all((long long *)GlbNumUpdates, (long long *)ProcBound,
+                                1, 0,0, NumProcs, llpWrk, llpSync);
+      shmem_barrier_all();
+      run->updates = (double) *GlbNumUpdates;
+
+      /* Print timing results */
+      if (MyProc == 0){
+        *GUPs = 1e-9*run->updates / RealTime;
+        fprintf( outFile, "Update mode: %s\n", run->name );
+        fprintf( outFile, "Contexts: %s", ctxname );
+        if (RA_CtxFallback)
+          fprintf( outFile, ", %d fell back to the default context on PE 0", RA_CtxFallback );
+        fprintf( outFile, "\n" );
+        if (timeBound > 0)
+          fprintf( outFile, "Time bound = %.3f seconds, calibrated on %lld updates/PE, "
+                   "updates done = %.0f (%.1f%%)\n", timeBound, (long long) CalNumUpdates,
+                   run->updates, 100.0 * run->updates / NumUpdates );
+        fprintf( outFile, "Real time used = %.6f seconds\n", RealTime );
+        fprintf( outFile, "%.9f Billion(10^9) Updates    per second [GUP/s]\n",
+                 *GUPs );
+        fprintf( outFile, "%.9f Billion(10^9) Updates/PE per second [GUP/s]\n",
+                 *GUPs / NumProcs );
+      }
 
-  count = (s64Int *) shmem_malloc(sizeof(s64Int));
-  s64Int **updates = (s64Int **) shmem_malloc(sizeof(s64Int *) * NumProcs);/*SP: A 2D array of npes X nt to avoid overwrites*/
-  for(i=0;i<NumProcs;i++)
-    updates[i] = (s64Int *) shmem_malloc(sizeof(s64Int) * nt);
-
-  all_updates = (s64Int *) shmem_malloc(sizeof(s64Int) * NumProcs);/*SP: An array to collect sum*/
-
-  ran = starts(4*GlobalStartMyProc);
-
-  niterate = ProcNumUpdates;
-  logTableLocal = logTableSize - logNumProcs;
-  nlocalm1 = LocalTableSize - 1;
-
-  
-  for (i = 0; i < NumProcs; i++){
-    for (j = 0; j < nt; j++){
-      updates[i][j] = 0;
-    }
-  }
-  int verify=0, total_updates=0; 
-  u64Int remote_val;
-
-  shmem_barrier_all();
-
+      /* Per-thread update rates, min/avg/max over the PEs */
+      for (j = 0; j < nt; j++) {
+        s64Int first, last;
 
-  /* Begin timed section */
-  RealTime = -RTSEC();
+        RA_ThreadShare(RunNumUpdates, j, nt, &first, &last);
+        ThreadRate[j] = 1e-6 * (last - first) / RA_ThreadTime[j];
+      }
+      shmem_double_min_to_all(ThreadStat, ThreadRate, nt, 0,0, NumProcs, dWrk, llpSync);
+      shmem_barrier_all();
+      shmem_double_max_to_all(ThreadStat + nt, ThreadRate, nt, 0,0, NumProcs, dWrk, llpSync);
+      shmem_barrier_all();
+      shmem_double_sum_to_all(ThreadStat + 2*nt, ThreadRate, nt, 0,0, NumProcs, dWrk, llpSync);
+      shmem_barrier_all();
+      if (MyProc == 0) {
+        fprintf( outFile, "%8s %14s %14s %14s %14s\n", "Thread", "Updates/PE",
+                 "min MUP/s", "avg MUP/s", "max MUP/s" );
+        for (j = 0; j < nt; j++) {
+          s64Int first, last;
+
+          RA_ThreadShare(RunNumUpdates, j, nt, &first, &last);
+          fprintf( outFile, "%8d %14lld", j, (long long) (last - first) );
+          fprintf( outFile, " %14.3f %14.3f %14.3f\n", ThreadStat[j],
+                   ThreadStat[2*nt + j] / NumProcs, ThreadStat[nt + j] );
+        }
+      }
 
-#pragma omp parallel firstprivate(ran) private(tid,remote_proc,remote_val)
-{
-  tid = omp_get_thread_num();
-  shmem_ctx_h ctx;
-  shmem_ctx_create( &ctx );
-
-#pragma omp for private(iterate) 
-  for (iterate = 0; iterate < niterate; iterate++) {
-      ran = (ran << 1) ^ ((s64Int) ran < ZERO64B ? POLY : ZERO64B);
-      remote_proc = (ran >> logTableLocal) & (NumProcs - 1);
-
-      /*Forces updates to remote PE only*/
-      if(remote_proc == MyProc)
-        remote_proc = (remote_proc+1)%NumProcs;
-   
-      remote_val  = shmem_ctx_longlong_g(ctx, &HPCC_Table[ran & (LocalTableSize-1)],remote_proc);
-      remote_val ^= ran;
-      shmem_ctx_longlong_p(ctx, &HPCC_Table[ran & (LocalTableSize-1)],remote_val, remote_proc);
-      shmem_ctx_quiet(ctx);
-
-      if(verify){
-        shmem_ctx_longlong_inc(ctx, &(updates[MyProc][tid]), remote_proc);
+      shmem_barrier_all();
+
+      if (CheckErrors) {
+        RealTime = -RTSEC();
+        *NumErrors = RandomAccessCheck(logTableSize, TableSize, LocalTableSize,
+                                       MinLocalTableSize, GlobalStartMyProc, Top,
+                                       logNumProcs, NumProcs, Remainder, MyProc,
+                                       RunNumUpdates);
+        shmem_longlong_sum_to_all(GlbNumErrors, NumErrors, 1, 0,0, NumProcs, llpWrk, llpSync);
+        RealTime += RTSEC();
+        run->errors = *GlbNumErrors;
+        if (MyProc == 0) {
+          fprintf( outFile, "Verification:  Real time used = %.6f seconds\n", RealTime );
+          fprintf( outFile, "Found " FSTR64 " errors in " FSTR64 " locations (%s).\n",
+                   *GlbNumErrors, TableSize, (*GlbNumErrors <= 0.01*TableSize) ?
+                   "passed" : "failed");
+        }
+        shmem_barrier_all();
       }
+      /* End verification phase */
+    }
   }
- }//end omp-parallel 
-  shmem_barrier_all();
-  /* End timed section */
-  RealTime += RTSEC();
 
-
-
-  /* Print timing results */
-  if (MyProc == 0){
-    *GUPs = 1e-9*NumUpdates / RealTime;
-    fprintf( outFile, "Real time used = %.6f seconds\n", RealTime );
-    fprintf( outFile, "%.9f Billion(10^9) Updates    per second [GUP/s]\n",
-             *GUPs );
-    fprintf( outFile, "%.9f Billion(10^9) Updates/PE per second [GUP/s]\n",
-             *GUPs / NumProcs );
-  }
- 
-  if(verify){
-    for (i = 0; i < NumProcs; i++)
-      for (j = 0; j < nt; j++){
-        total_updates += updates[i][j];
-      }
-    int cpu = sched_getcpu();
-
-    shmem_longlong_sum_to_all(all_updates,updates, NumProcs, 0,0, NumProcs,llpWrk, llpSync);
-    if(MyProc == 0){
-      for (j = 1; j < NumProcs; j++)
-        all_updates[0] += all_updates[j];
-      if(ProcNumUpdates*NumProcs == all_updates[0])
-        printf("Verification passed!\n");
-      else
-        printf("Verification failed!\n");
+  /* Side-by-side summary when more than one run was timed */
+  if (MyProc == 0 && NumRuns > 1) {
+    fprintf( outFile, "\n%-20s %14s %14s %14s", "Mode", "Seconds", "GUP/s", "GUP/s/PE" );
+    fprintf( outFile, CheckErrors ? " %14s\n" : "\n", "Errors" );
+    for (run = Runs; run < Runs + NumRuns; run++) {
+      fprintf( outFile, "%-20s %14.6f %14.9f %14.9f", run->name, run->time,
+               1e-9*run->updates / run->time, 1e-9*run->updates / run->time / NumProcs );
+      if (CheckErrors)
+        fprintf( outFile, " %14lld", (long long) run->errors );
+      fprintf( outFile, "\n" );
     }
   }
-  shmem_barrier_all();
-  /* End verification phase */
 
 
-  shmem_free(count);
-  for(i=0;i<NumProcs;i++)
-    shmem_free(updates[i]);
-  shmem_free(updates);
+  shmem_free(dWrk);
+  shmem_free(ThreadStat);
+  shmem_free(ThreadRate);
   shmem_barrier_all();
 
   /* Deallocate memory (in reverse order of allocation which should
  *      help fragmentation) */
 
-  HPCC_free( HPCC_Table );
+  shmem_free( HPCC_Table );
   failed_table:
 
   if (0 == MyProc) if (outFile != stderr) fclose( outFile );
@@ -328,6 +727,8 @@ int main(int argc, char **argv)
 
   shmem_free(sAbort);
   shmem_free(rAbort);
+  shmem_free(GlbNumUpdates);
+  shmem_free(ProcBound);
   shmem_free(llpSync);
   shmem_free(llpWrk);
   shmem_free(ipSync);
@@ -339,48 +740,3 @@ int main(int argc, char **argv)
 
   return 0;
 }
-
-/* Utility routine to start random number generator at Nth step */
-s64Int
-starts(u64Int n)
-{
-  /* s64Int i, j; */
-  int i, j;
-  u64Int m2[64];
-  u64Int temp, ran;
-
-  while (n < 0)
-    n += PERIOD;
-  while (n > PERIOD)
-    n -= PERIOD;
-  if (n == 0)
-    return 0x1;
-
-  temp = 0x1;
-  for (i=0; i<64; i++)
-    {
-      m2[i] = temp;
-      temp = (temp << 1) ^ ((s64Int) temp < 0 ? POLY : 0);
-      temp = (temp << 1) ^ ((s64Int) temp < 0 ? POLY : 0);
-    }
-
-  for (i=62; i>=0; i--)
-    if ((n >> i) & 1)
-      break;
-
-  ran = 0x2;
-
-  while (i > 0)
-    {
-      temp = 0;
-      for (j=0; j<64; j++)
-        if ((ran >> j) & 1)
-          temp ^= m2[j];
-      ran = temp;
-      i -= 1;
-      if ((n >> i) & 1)
-        ran = (ran << 1) ^ ((s64Int) ran < 0 ? POLY : 0);
-    }
-
-  return ran;
-}
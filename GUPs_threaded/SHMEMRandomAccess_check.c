@@ -0,0 +1,97 @@
+/*
+Copyright (C) 2008-2018, UT-Battelle, LLC.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the New BSD 3-clause software license (LICENSE).
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+LICENSE for more details.
+*/
+
+/*
+ * Error check for the OpenSHMEM RandomAccess benchmark.
+ *
+ * As in HPCC, the update stream is regenerated and applied a second time.
+ * Since every update is an XOR, a table that received all updates exactly
+ * once returns to its initial state (HPCC_Table[i] == MyProc); every word
+ * that does not is counted as an error.  HPCC accepts up to 1% errors, which
+ * covers the races of the non-atomic update modes.
+ */
+
+#include <hpcc.h>
+#include <stdio.h>
+#include "RandomAccess.h"
+#include <shmem.h>
+#include <omp.h>
+
+/*
+ * All PEs replay their stream at once, each split over the OpenMP threads
+ * as in the update engines, with non-fetching atomic XORs on a context per
+ * thread.  The check cannot lose updates to races of its own, and the
+ * barrier completes the XORs before the threads count the local errors.
+ */
+s64Int
+RandomAccessCheck(u64Int logTableSize,
+                  u64Int TableSize,
+                  u64Int LocalTableSize,
+                  u64Int MinLocalTableSize,
+                  u64Int GlobalStartMyProc,
+                  u64Int Top,
+                  int logNumProcs,
+                  int NumProcs,
+                  int Remainder,
+                  int MyProc,
+                  s64Int ProcNumUpdates)
+{
+  s64Int i, errors;
+  int logTableLocal;
+
+  logTableLocal = logTableSize - logNumProcs;
+
+  shmem_barrier_all();
+#pragma omp parallel
+{
+  shmem_ctx_t ctx;
+  s64Int iterate, first, last, nblock, j;
+  int remote_proc;
+  u64Int ran, offset;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+
+  RA_ThreadShare(ProcNumUpdates, omp_get_thread_num(), omp_get_num_threads(),
+                 &first, &last);
+  RA_StreamInit(&stream, 4*GlobalStartMyProc + first);
+
+  if (shmem_ctx_create(0, &ctx))
+    ctx = SHMEM_CTX_DEFAULT;
+
+  for (iterate = first; iterate < last; iterate += nblock) {
+    nblock = last - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (j = 0; j < nblock; j++) {
+      ran = block[j];
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+      shmem_atomic_xor(ctx, &HPCC_Table[offset], ran, remote_proc);
+    }
+  }
+
+  shmem_ctx_quiet(ctx);
+  if (ctx != SHMEM_CTX_DEFAULT)
+    shmem_ctx_destroy(ctx);
+ }//end omp-parallel
+  shmem_barrier_all();
+
+  errors = 0;
+#pragma omp parallel for reduction(+:errors)
+  for (i = 0; i < (s64Int) LocalTableSize; i++)
+    if (HPCC_Table[i] != (u64Int) MyProc)
+      errors++;
+
+  return errors;
+}
@@ -0,0 +1,420 @@
+/*
+Copyright (C) 2008-2018, UT-Battelle, LLC.
+
+This program is free software; you can redistribute it and/or modify
+it under the terms of the New BSD 3-clause software license (LICENSE).
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+LICENSE for more details.
+*/
+
+/*
+ * Update engines for the multithreaded OpenSHMEM RandomAccess benchmark.
+ *
+ * Each OpenMP thread issues its share of the PE's updates on the shmem
+ * context RA_CtxPolicy gives it: one of its own (the default), one shared
+ * with other threads, or the default context.  The PE's part of the HPCC stream is split into
+ * one contiguous block per thread (RA_ThreadShare) and every thread jumps
+ * to the start of its block with starts(), so the threads generate
+ * disjoint pieces of the same stream whatever the thread count.
+ *
+ * Each engine times the update phase between two barriers and returns the
+ * elapsed real time; the time every thread spent in its own update loop is
+ * left in RA_ThreadTime[].  Context operations are not completed by
+ * shmem_barrier_all(), so every thread quiets its context before the
+ * closing barrier.
+ */
+
+#include <hpcc.h>
+#include <stdio.h>
+#include <string.h>
+#include "RandomAccess.h"
+#include <shmem.h>
+#include <omp.h>
+
+/* Contexts of the RA_CTX_POOL policy, shared by the threads of a run */
+static shmem_ctx_t *CtxPool;
+static int NumCtxPool;
+
+/* Create the shared contexts before the threads start issuing on them */
+static void
+ctx_pool_create(int nthreads)
+{
+  int i;
+
+  NumCtxPool = 0;
+  if (RA_CtxPolicy != RA_CTX_POOL)
+    return;
+
+  NumCtxPool = (RA_CtxPool > 0 && RA_CtxPool < nthreads) ? RA_CtxPool : nthreads;
+  CtxPool = XMALLOC(shmem_ctx_t, NumCtxPool);
+  if (! CtxPool) {
+    fprintf(stderr, "PE%d: failed to allocate context pool\n", shmem_my_pe());
+    shmem_global_exit(1);
+  }
+  for (i = 0; i < NumCtxPool; i++)
+    if (shmem_ctx_create(0, &CtxPool[i])) {
+      CtxPool[i] = SHMEM_CTX_DEFAULT;
+      RA_CtxFallback++;
+    }
+}
+
+static void
+ctx_pool_destroy(void)
+{
+  int i;
+
+  for (i = 0; i < NumCtxPool; i++)
+    if (CtxPool[i] != SHMEM_CTX_DEFAULT)
+      shmem_ctx_destroy(CtxPool[i]);
+  if (NumCtxPool)
+    free(CtxPool);
+  NumCtxPool = 0;
+}
+
+/* Context thread tid issues on; a thread's own context is created here */
+static shmem_ctx_t
+ctx_get(int tid)
+{
+  shmem_ctx_t ctx;
+
+  if (RA_CtxPolicy == RA_CTX_SHARED)
+    return SHMEM_CTX_DEFAULT;
+  if (RA_CtxPolicy == RA_CTX_POOL)
+    return CtxPool[tid % NumCtxPool];
+
+  if (shmem_ctx_create(RA_CtxPolicy == RA_CTX_PRIVATE ? SHMEM_CTX_PRIVATE :
+                       SHMEM_CTX_SERIALIZED, &ctx)) {
+    ctx = SHMEM_CTX_DEFAULT;
+#pragma omp atomic
+    RA_CtxFallback++;
+  }
+  return ctx;
+}
+
+/* Release what ctx_get() created; pooled contexts outlive the thread */
+static void
+ctx_put(shmem_ctx_t ctx)
+{
+  if ((RA_CtxPolicy == RA_CTX_PRIVATE || RA_CtxPolicy == RA_CTX_SERIALIZED) &&
+      ctx != SHMEM_CTX_DEFAULT)
+    shmem_ctx_destroy(ctx);
+}
+
+/*
+ * The timed section is opened and closed by the master thread inside the
+ * parallel region, after every thread holds its context and before any
+ * releases it, so creating and destroying contexts is never timed.  A
+ * SHMEM_CTX_PRIVATE context has to be created by the thread that uses it,
+ * which rules out creating them all ahead of the region.
+ */
+static void
+timed_section_begin(double *RealTime)
+{
+#pragma omp barrier
+#pragma omp master
+  {
+    shmem_barrier_all();
+    *RealTime = -RTSEC();
+  }
+#pragma omp barrier
+}
+
+static void
+timed_section_end(double *RealTime)
+{
+#pragma omp barrier
+#pragma omp master
+  {
+    shmem_barrier_all();
+    *RealTime += RTSEC();
+  }
+#pragma omp barrier
+}
+
+/*
+ * Reference engine: one blocking get, xor and put per update, completed
+ * with a context quiet before the thread issues its next update.
+ */
+double
+GetPutRandomAccessUpdate(u64Int logTableSize,
+                         u64Int TableSize,
+                         u64Int LocalTableSize,
+                         u64Int MinLocalTableSize,
+                         u64Int GlobalStartMyProc,
+                         u64Int Top,
+                         int logNumProcs,
+                         int NumProcs,
+                         int Remainder,
+                         int MyProc,
+                         s64Int ProcNumUpdates)
+{
+  int logTableLocal;
+  double RealTime;
+
+  logTableLocal = logTableSize - logNumProcs;
+  ctx_pool_create(omp_get_max_threads());
+
+#pragma omp parallel
+{
+  shmem_ctx_t ctx;
+  s64Int iterate, first, last;
+  int tid, remote_proc;
+  u64Int ran, remote_val, offset;
+  double ThreadTime;
+
+  tid = omp_get_thread_num();
+  RA_ThreadShare(ProcNumUpdates, tid, omp_get_num_threads(), &first, &last);
+  ran = starts(4*GlobalStartMyProc + first);
+
+  ctx = ctx_get(tid);
+  timed_section_begin(&RealTime);
+
+  ThreadTime = -RTSEC();
+  for (iterate = first; iterate < last; iterate++) {
+      ran = (ran << 1) ^ ((s64Int) ran < ZERO64B ? POLY : ZERO64B);
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+
+      remote_val  = shmem_ctx_longlong_g(ctx, (long long *)&HPCC_Table[offset],remote_proc);
+      remote_val ^= ran;
+      shmem_ctx_longlong_p(ctx, (long long *)&HPCC_Table[offset],remote_val, remote_proc);
+      shmem_ctx_quiet(ctx);
+  }
+
+  shmem_ctx_quiet(ctx);
+  RA_ThreadTime[tid] = ThreadTime + RTSEC();
+  timed_section_end(&RealTime);
+  ctx_put(ctx);
+ }//end omp-parallel
+
+  ctx_pool_destroy();
+
+  return RealTime;
+}
+
+/*
+ * Atomic engine: one non-fetching shmem_atomic_xor on the thread's context
+ * per update.  The XOR is performed at the owner, so concurrent updates
+ * from other PEs and threads cannot race.
+ */
+double
+AMORandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates)
+{
+  int logTableLocal;
+  double RealTime;
+
+  logTableLocal = logTableSize - logNumProcs;
+  ctx_pool_create(omp_get_max_threads());
+
+#pragma omp parallel
+{
+  shmem_ctx_t ctx;
+  s64Int iterate, first, last, nblock, i;
+  int tid, remote_proc;
+  u64Int ran, offset;
+  u64Int block[RA_STREAM_BLOCK];
+  RA_Stream_t stream;
+  double ThreadTime;
+
+  tid = omp_get_thread_num();
+  RA_ThreadShare(ProcNumUpdates, tid, omp_get_num_threads(), &first, &last);
+  RA_StreamInit(&stream, 4*GlobalStartMyProc + first);
+
+  ctx = ctx_get(tid);
+  timed_section_begin(&RealTime);
+
+  ThreadTime = -RTSEC();
+  for (iterate = first; iterate < last; iterate += nblock) {
+    nblock = last - iterate;
+    if (nblock > RA_STREAM_BLOCK)
+      nblock = RA_STREAM_BLOCK;
+    RA_StreamFill(&stream, block, nblock);
+
+    for (i = 0; i < nblock; i++) {
+      ran = block[i];
+      remote_proc = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                              Remainder, NumProcs, MyProc, &offset);
+      shmem_atomic_xor(ctx, &HPCC_Table[offset], ran, remote_proc);
+    }
+  }
+
+  shmem_ctx_quiet(ctx);
+  RA_ThreadTime[tid] = ThreadTime + RTSEC();
+  timed_section_end(&RealTime);
+  ctx_put(ctx);
+ }//end omp-parallel
+
+  ctx_pool_destroy();
+
+  return RealTime;
+}
+
+/*
+ * Table words read by the window being issued, so the nbi engine can end a
+ * window before it reads a word twice: the second get would return the
+ * value from before the first update's write-back and one of the two XORs
+ * would be lost.  The HPCC stream makes such repeats common (later values
+ * are shifts of earlier ones), far above the 1% error tolerance for deep
+ * windows.  Open addressing over a power of two; entries of older windows
+ * are told apart by their generation, so starting a window is O(1).
+ */
+typedef struct {
+  u64Int *word;
+  u64Int *gen;
+  u64Int mask, current;
+} RA_WindowSet_t;
+
+static int
+window_set_init(RA_WindowSet_t *set, int window)
+{
+  u64Int size = 2;
+
+  while (size < 2 * (u64Int) window)
+    size <<= 1;
+  set->word = XMALLOC(u64Int, size);
+  set->gen = XMALLOC(u64Int, size);
+  if (! set->word || ! set->gen)
+    return 1;
+  memset(set->gen, 0, size * sizeof(u64Int));
+  set->mask = size - 1;
+  set->current = 0;
+  return 0;
+}
+
+static void
+window_set_free(RA_WindowSet_t *set)
+{
+  free(set->gen);
+  free(set->word);
+}
+
+/* Add word to the current window's set; 1 if it was already there */
+static int
+window_set_insert(RA_WindowSet_t *set, u64Int word)
+{
+  u64Int h = ((word * 0x9E3779B97F4A7C15ULL) >> 32) & set->mask;
+
+  for (; set->gen[h] == set->current; h = (h + 1) & set->mask)
+    if (set->word[h] == word)
+      return 1;
+  set->gen[h] = set->current;
+  set->word[h] = word;
+  return 0;
+}
+
+/*
+ * Windowed engine: every thread keeps RA_Window updates in flight on its
+ * context.  The gets of a window are issued with shmem_ctx_longlong_get_nbi
+ * into a per-thread ring of local slots and retired by a single context
+ * quiet; the XORed values are written back with shmem_ctx_longlong_p and
+ * completed by a second quiet before the thread's next window reads the
+ * table.  A window ends early at the first update whose word it already
+ * reads; the stream values drawn past that point open the next window.
+ */
+double
+NBIRandomAccessUpdate(u64Int logTableSize,
+                      u64Int TableSize,
+                      u64Int LocalTableSize,
+                      u64Int MinLocalTableSize,
+                      u64Int GlobalStartMyProc,
+                      u64Int Top,
+                      int logNumProcs,
+                      int NumProcs,
+                      int Remainder,
+                      int MyProc,
+                      s64Int ProcNumUpdates)
+{
+  int logTableLocal;
+  double RealTime;
+
+  logTableLocal = logTableSize - logNumProcs;
+  ctx_pool_create(omp_get_max_threads());
+
+#pragma omp parallel
+{
+  shmem_ctx_t ctx;
+  s64Int iterate, i, first, last, nwindow, pending;
+  int tid;
+  u64Int ran, offset;
+  u64Int *slot, *slot_ran, *slot_off;
+  int *slot_pe;
+  RA_Stream_t stream;
+  RA_WindowSet_t seen;
+  double ThreadTime;
+
+  tid = omp_get_thread_num();
+  RA_ThreadShare(ProcNumUpdates, tid, omp_get_num_threads(), &first, &last);
+  RA_StreamInit(&stream, 4*GlobalStartMyProc + first);
+
+  slot = XMALLOC(u64Int, RA_Window);
+  slot_ran = XMALLOC(u64Int, RA_Window);
+  slot_off = XMALLOC(u64Int, RA_Window);
+  slot_pe = XMALLOC(int, RA_Window);
+  if (! slot || ! slot_ran || ! slot_off || ! slot_pe || window_set_init(&seen, RA_Window)) {
+    fprintf(stderr, "PE%d: failed to allocate update window\n", MyProc);
+    shmem_global_exit(1);
+  }
+
+  ctx = ctx_get(tid);
+  timed_section_begin(&RealTime);
+
+  ThreadTime = -RTSEC();
+  for (iterate = first, pending = 0; iterate < last; iterate += nwindow) {
+    nwindow = last - iterate;
+    if (nwindow > RA_Window)
+      nwindow = RA_Window;
+
+    RA_StreamFill(&stream, slot_ran + pending, nwindow - pending);
+    seen.current++;
+    for (i = 0; i < nwindow; i++) {
+      ran = slot_ran[i];
+      slot_pe[i] = RA_Target(ran, logTableLocal, TableSize, MinLocalTableSize, Top,
+                             Remainder, NumProcs, MyProc, &offset);
+      slot_off[i] = offset;
+      if (window_set_insert(&seen, offset * NumProcs + slot_pe[i]))
+        break;
+      shmem_ctx_longlong_get_nbi(ctx, (long long *)&slot[i],
+                                 (long long *)&HPCC_Table[offset],
+                                 1, slot_pe[i]);
+    }
+    pending = nwindow - i;
+    nwindow = i;
+
+    shmem_ctx_quiet(ctx);
+
+    for (i = 0; i < nwindow; i++)
+      shmem_ctx_longlong_p(ctx, (long long *)&HPCC_Table[slot_off[i]],
+                           slot[i] ^ slot_ran[i], slot_pe[i]);
+
+    shmem_ctx_quiet(ctx);
+    memmove(slot_ran, slot_ran + nwindow, pending * sizeof(u64Int));
+  }
+
+  RA_ThreadTime[tid] = ThreadTime + RTSEC();
+  timed_section_end(&RealTime);
+  ctx_put(ctx);
+
+  window_set_free(&seen);
+  free(slot_pe);
+  free(slot_off);
+  free(slot_ran);
+  free(slot);
+ }//end omp-parallel
+
+  ctx_pool_destroy();
+
+  return RealTime;
+}
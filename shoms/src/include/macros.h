@@ -75,3 +75,22 @@
   declare_test(shmem_ ## test_name ## 32);\
   declare_test(shmem_ ## test_name ## 64);\
   declare_test(shmem_ ## test_name ## 128)
+
+#define atomic_type_tests(test_name) \
+  declare_test(shmem_int_ ## test_name);\
+  declare_test(shmem_long_ ## test_name);\
+  declare_test(shmem_longlong_ ## test_name)
+
+#define atomic_bitwise_type_tests(test_name) \
+  declare_test(shmem_uint_ ## test_name);\
+  declare_test(shmem_ulong_ ## test_name);\
+  declare_test(shmem_ulonglong_ ## test_name)
+
+#define rate_type_tests(test_name) \
+  declare_test(shmem_short_ ## test_name);\
+  declare_test(shmem_int_ ## test_name);\
+  declare_test(shmem_long_ ## test_name);\
+  declare_test(shmem_longlong_ ## test_name);\
+  declare_test(shmem_float_ ## test_name);\
+  declare_test(shmem_double_ ## test_name);\
+  declare_test(shmem_longdouble_ ## test_name)
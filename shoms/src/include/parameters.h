@@ -24,4 +24,6 @@
 
 void process_params(int argc, char **argv, parsed_options_t *set_options, test_t **test_list, index_t *test_length, iteration_data_t **iterations, index_t *iterations_length);
 
+int threads_requested(int argc, char **argv);
+
 #endif
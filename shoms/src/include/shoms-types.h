@@ -40,15 +40,25 @@ typedef int64_t index_t;
 #define INDEX_MAX INT64_MAX
 #endif
 
+/* Log-linear latency histogram: ticks below 2^HIST_SUB_BITS get a bucket
+   each, every larger power of two is split into 2^HIST_SUB_BITS buckets */
+#define HIST_SUB_BITS 3
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS)
+
 typedef struct {
   ORB_tick_t accumulated_time_tick;
   ORB_tick_t min_time_tick;
   ORB_tick_t max_time_tick;
   double avg_time_tick;
   double bandwidth_bytes_per_tick;
+  double messages_per_tick;
+  double pe_bandwidth_bytes_per_tick;
+  double overlap_percent;
   index_t transfered_data_bytes;
   index_t message_size;
   index_t iterations;
+  long long histogram[HIST_BUCKETS];
 } test_results_t;
 
 typedef struct {
@@ -85,6 +95,12 @@ typedef struct {
   long *pSync;
 } collective_buffers_t;
 
+typedef struct {
+  void *symetric;
+  void *local;
+  uint64_t *signal;
+} signal_buffers_t;
+
 typedef struct {
   char *buffer;
   size_t size;
@@ -129,6 +145,17 @@ typedef struct {
   void *buffer;
 } buffer_ptr_t;
 
+/* Which PEs the point to point tests target, see init_traffic_pattern() */
+typedef enum {
+  PATTERN_ROOT = 0,
+  PATTERN_PAIRWISE,
+  PATTERN_RING,
+  PATTERN_ALLTOALL,
+  PATTERN_INCAST,
+  PATTERN_RANDOM,
+  PATTERN_COUNT
+} traffic_pattern_t;
+
 typedef struct parsed_options {
   int32_t affinity_test;
   int32_t disable_cache;
@@ -138,6 +165,10 @@ typedef struct parsed_options {
   index_t minimum_size;
   index_t maximum_size;
   index_t run_time;
+  index_t message_window;
+  traffic_pattern_t pattern;
+  index_t pattern_arg;
+  index_t max_threads;
   char *output_file_path;
   FILE *output_file;
 } parsed_options_t;
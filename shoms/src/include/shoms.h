@@ -27,7 +27,16 @@
 #include <shmem.h>
 #endif
 
+/* True when the library implements at least OpenSHMEM major.minor */
+#if defined(SHMEM_MAJOR_VERSION) && defined(SHMEM_MINOR_VERSION)
+#define SHOMS_SHMEM_AT_LEAST(major, minor) \
+  (SHMEM_MAJOR_VERSION > (major) || (SHMEM_MAJOR_VERSION == (major) && SHMEM_MINOR_VERSION >= (minor)))
+#else
+#define SHOMS_SHMEM_AT_LEAST(major, minor) 0
+#endif
+
 #include <stdint.h>
+#include <sys/time.h>
 #include <orbtimer.h>
 #include <limits.h>
 #include <macros.h>
@@ -35,19 +44,36 @@
 
 extern int global_npes;
 extern int global_my_pe;
+extern index_t global_message_window;
+extern traffic_pattern_t global_pattern;
+extern int *global_targets;
+extern int global_target_count;
+extern char *pattern_names[];
+extern char global_pattern_label[];
+extern int global_bidir_k;
 
 #define REMOTE_PES (global_npes-1)
 #define N_PES (global_npes)
 #define MY_PE (global_my_pe)
+#define TARGET_COUNT (global_target_count)
+#define TARGET_PE(index) (global_targets[index])
+#define BIDIR_PARTNER ((MY_PE ^ global_bidir_k) < N_PES ? (MY_PE ^ global_bidir_k) : -1)
 
-#define NUM_TESTS ((index_t)128)
-#define MAX_TESTS ((index_t)128)
+#define NUM_TESTS ((index_t)256)
+#define MAX_TESTS ((index_t)256)
+#define DEFAULT_MESSAGE_WINDOW 64
 
 void init_tests();
 index_t all_tests(test_t **tests_array);
 index_t affinity_tests(test_t **tests_array);
 void free_test_t(test_t *doomed, index_t size);
 
+/* --time: collective, every PE gets the same answer */
+void set_max_run_time(struct timeval *timer, parsed_options_t *input_options);
+int check_run_time(struct timeval *end_timer, parsed_options_t *input_options);
+
+void run_threaded_tests(iteration_data_t *iterations, index_t iterations_length, parsed_options_t *input_options);
+
 index_t init_iterations(iteration_data_t **iterations_array, index_t data_min, index_t data_max);
 void free_iterations(iteration_data_t doomed, index_t size);
 
@@ -76,6 +102,12 @@ void cleanup_distributed_buffer(void *buffer);
 void calculate_local_performance(test_results_t *test_results);
 void calculate_global_performance(test_results_t *test_results);
 void calculate_global_no_bw_performance(test_results_t *test_results);
+void calculate_rate_performance(test_results_t *test_results);
+void calculate_p2p_performance(test_results_t *test_results);
+void calculate_bidir_performance(test_results_t *test_results);
+void calculate_overlap_performance(test_results_t *test_results);
+void record_time_tick(test_results_t *test_results, ORB_tick_t time_tick);
+ORB_tick_t percentile_time_tick(test_results_t *test_results, double fraction);
 
 declare_with_common_types(type_buffer_alloc_prototype)
 declare_with_common_types(init_sym_and_local_prototype)
@@ -90,6 +122,46 @@ common_type_tests(g);
 common_type_tests(get);
 common_type_tests(iget);
 
+#if SHOMS_SHMEM_AT_LEAST(1, 3)
+rate_type_tests(put_nbi);
+rate_type_tests(get_nbi);
+declare_test(shmem_putmem_overlap);
+#endif
+
+rate_type_tests(put_bidir);
+rate_type_tests(get_bidir);
+
+#if SHOMS_SHMEM_AT_LEAST(1, 4)
+atomic_type_tests(atomic_fetch);
+atomic_type_tests(atomic_set);
+atomic_type_tests(atomic_compare_swap);
+atomic_bitwise_type_tests(atomic_fetch_and);
+atomic_bitwise_type_tests(atomic_fetch_or);
+atomic_bitwise_type_tests(atomic_fetch_xor);
+
+declare_test(shmem_sync);
+declare_test(shmem_sync_all);
+#endif
+
+#if SHOMS_SHMEM_AT_LEAST(1, 5)
+declare_test(shmem_putmem_signal);
+declare_test(shmem_putmem_signal_nbi);
+declare_test(shmem_signal_fetch);
+declare_test(shmem_broadcastmem);
+declare_test(shmem_alltoallmem);
+declare_test(shmem_team_sync);
+
+atomic_type_tests(sum_reduce);
+atomic_type_tests(prod_reduce);
+atomic_type_tests(min_reduce);
+atomic_type_tests(max_reduce);
+atomic_bitwise_type_tests(and_reduce);
+atomic_bitwise_type_tests(or_reduce);
+atomic_bitwise_type_tests(xor_reduce);
+
+void free_signal_buffers(void *doomed);
+#endif
+
 common_type_tests(and_to_all);
 common_type_tests(or_to_all);
 common_type_tests(xor_to_all);
@@ -46,29 +46,54 @@
 
 int global_npes;
 int global_my_pe;
+index_t global_message_window = DEFAULT_MESSAGE_WINDOW;
+traffic_pattern_t global_pattern = PATTERN_ROOT;
+int *global_targets = NULL;
+int global_target_count = 0;
+char global_pattern_label[64] = "root";
+int global_bidir_k = 1;
 
 void print_mem_management_stats();
 
 void print_header(test_t *current_test, parsed_options_t *input_options){
   if(shmem_my_pe() == 0){
+    char bidir_label[64];
+    char *label = global_pattern_label;
+
+    /* The bidirectional tests always pair PEs, whatever --pattern says */
+    if(current_test->collect_results == calculate_bidir_performance){
+      snprintf(bidir_label, sizeof(bidir_label), "pairwise:%d", global_bidir_k);
+      label = bidir_label;
+    }
     fprintf(input_options->output_file, "\n#---------------------------------------------------\n"
-                                          "# Benchmarking %s \n# #processes = %d\n"
+                                          "# Benchmarking %s \n# #processes = %d\n# pattern = %s\n"
                                           "#---------------------------------------------------\n"
-                                          "       #bytes  #repetitions     t_min[nsec]     t_max[nsec]       t_avg[nsec]      Bw_aggregated[MB/sec]\n",
-                                          current_test->name, global_npes );
+                                          "       #bytes  #repetitions     t_min[nsec]     t_max[nsec]       t_avg[nsec]      Bw_aggregated[MB/sec]"
+                                          "     t_p50[nsec]     t_p90[nsec]     t_p99[nsec]   t_p99.9[nsec]"
+                                          "   Msg_rate[M/sec]   Bw_per_PE[MB/sec]   Overlap[%%]\n",
+                                          current_test->name, global_npes, label );
   }
 }
 
 char *NA = "N/A";
 
+static unsigned long ticks_to_ns(ORB_tick_t ticks){
+  return (unsigned long)round(((double)ticks * ORB_REFFREQ) / (double)1000000000);
+}
+
 void print_performance_data(test_t *current_test, index_t test_data_size, index_t iterations_count, parsed_options_t *input_options){
   if(global_my_pe == 0){
     char bw_buffer[1024];
+    char rate_buffer[1024];
+    char pe_bw_buffer[1024];
+    char overlap_buffer[1024];
     char message_size_buffer[1024];
-    unsigned long min_time_ns = (unsigned long)round(((double)current_test->test_results->min_time_tick * ORB_REFFREQ) / (double)1000000000);
-    unsigned long max_time_ns = (unsigned long)round(((double)current_test->test_results->max_time_tick * ORB_REFFREQ) / (double)1000000000);
+    unsigned long min_time_ns = ticks_to_ns(current_test->test_results->min_time_tick);
+    unsigned long max_time_ns = ticks_to_ns(current_test->test_results->max_time_tick);
     double average_time = (current_test->test_results->avg_time_tick * ORB_REFFREQ) / (double)1000000000;
     double bandwidth = current_test->test_results->bandwidth_bytes_per_tick * ORB_REFFREQ / (double)(1024 * 1024);
+    double message_rate = current_test->test_results->messages_per_tick * ORB_REFFREQ / (double)1000000;
+    double pe_bandwidth = current_test->test_results->pe_bandwidth_bytes_per_tick * ORB_REFFREQ / (double)(1024 * 1024);
 
     if(current_test->test_results->transfered_data_bytes == 0){
       snprintf(message_size_buffer, 1024, "%13s", NA);
@@ -82,13 +107,110 @@ void print_performance_data(test_t *current_test, index_t test_data_size, index_
       snprintf(bw_buffer, 1024, "%12.2f", bandwidth);
     }
 
-    fprintf(input_options->output_file, "%s %13lu   %13lu   %13lu    %15.2f              %s\n", 
+    if(message_rate == (double)0){
+      snprintf(rate_buffer, 1024, "%15s", NA);
+    } else {
+      snprintf(rate_buffer, 1024, "%15.3f", message_rate);
+    }
+
+    if(pe_bandwidth == (double)0){
+      snprintf(pe_bw_buffer, 1024, "%17s", NA);
+    } else {
+      snprintf(pe_bw_buffer, 1024, "%17.2f", pe_bandwidth);
+    }
+
+    if(current_test->test_results->overlap_percent < 0){
+      snprintf(overlap_buffer, 1024, "%10s", NA);
+    } else {
+      snprintf(overlap_buffer, 1024, "%10.1f", current_test->test_results->overlap_percent);
+    }
+
+    fprintf(input_options->output_file, "%s %13lu   %13lu   %13lu    %15.2f              %s", 
             message_size_buffer, (unsigned long)iterations_count, min_time_ns, max_time_ns, average_time, bw_buffer);
+    fprintf(input_options->output_file, "   %13lu   %13lu   %13lu   %13lu   %s   %s   %s\n",
+            ticks_to_ns(percentile_time_tick(current_test->test_results, 0.50)),
+            ticks_to_ns(percentile_time_tick(current_test->test_results, 0.90)),
+            ticks_to_ns(percentile_time_tick(current_test->test_results, 0.99)),
+            ticks_to_ns(percentile_time_tick(current_test->test_results, 0.999)), rate_buffer, pe_bw_buffer, overlap_buffer);
     fflush(input_options->output_file);
   }
 }
 
-static void set_max_run_time(struct timeval *timer, parsed_options_t *input_options){
+/* Sattolo's shuffle gives a permutation that is a single cycle, so no PE
+   targets itself; every PE draws the same one from the seed */
+static int random_cycle_target(index_t seed){
+  int *cycle = malloc(sizeof(int) * N_PES);
+  uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+  int pick, swap, target;
+
+  for(int idx=0; idx < N_PES; idx++){
+    cycle[idx] = idx;
+  }
+  for(int idx=N_PES-1; idx > 0; idx--){
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    pick = state % idx;
+    swap = cycle[idx];
+    cycle[idx] = cycle[pick];
+    cycle[pick] = swap;
+  }
+  target = cycle[MY_PE];
+  free(cycle);
+  return target;
+}
+
+static void add_target(int target){
+  if(target != MY_PE && target >= 0 && target < N_PES){
+    global_targets[global_target_count++] = target;
+  }
+}
+
+void init_traffic_pattern(parsed_options_t *input_options){
+  global_pattern = input_options->pattern;
+  global_targets = malloc(sizeof(int) * N_PES);
+  global_target_count = 0;
+
+  /* The bidirectional tests follow pairwise:k and pair pe with pe^1 otherwise */
+  if(global_pattern == PATTERN_PAIRWISE && input_options->pattern_arg >= 1){
+    global_bidir_k = (int)input_options->pattern_arg;
+  }
+
+  /* k or the seed tells apart topologies of the same pattern */
+  if(global_pattern == PATTERN_PAIRWISE || global_pattern == PATTERN_RING || global_pattern == PATTERN_RANDOM){
+    snprintf(global_pattern_label, sizeof(global_pattern_label), "%s:%lu",
+             pattern_names[global_pattern], (unsigned long)input_options->pattern_arg);
+  } else {
+    snprintf(global_pattern_label, sizeof(global_pattern_label), "%s", pattern_names[global_pattern]);
+  }
+
+  switch(global_pattern){
+    case PATTERN_ROOT:
+      if(MY_PE == 0){
+        for(int idx=1; idx < N_PES; idx++) add_target(idx);
+      }
+      break;
+    case PATTERN_PAIRWISE:
+      add_target(MY_PE ^ (int)input_options->pattern_arg);
+      break;
+    case PATTERN_RING:
+      add_target((MY_PE + input_options->pattern_arg) % N_PES);
+      break;
+    case PATTERN_ALLTOALL:
+      for(int idx=1; idx < N_PES; idx++) add_target((MY_PE + idx) % N_PES);
+      break;
+    case PATTERN_INCAST:
+      add_target(0);
+      break;
+    case PATTERN_RANDOM:
+      add_target(random_cycle_target(input_options->pattern_arg));
+      break;
+    default:
+      break;
+  }
+}
+
+void set_max_run_time(struct timeval *timer, parsed_options_t *input_options){
   if(input_options->run_time == 0) return;
   gettimeofday(timer, NULL);
   timer->tv_sec += input_options->run_time;
@@ -98,7 +220,7 @@ int pWork_time[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
 long pSync_time[_SHMEM_REDUCE_SYNC_SIZE];
 int run_time_good;
 
-static int check_run_time(struct timeval *end_timer, parsed_options_t *input_options){
+int check_run_time(struct timeval *end_timer, parsed_options_t *input_options){
   struct timeval current;
   if(input_options->run_time == 0) return 0;
   gettimeofday(&current, NULL);
@@ -171,7 +293,11 @@ void run_tests(test_t *test_list, index_t test_length, iteration_data_t *iterati
       test_list[test_index].test_results->min_time_tick = INDEX_MAX;
       test_list[test_index].test_results->max_time_tick = INDEX_MIN;
       test_list[test_index].test_results->transfered_data_bytes = 0;
+      test_list[test_index].test_results->messages_per_tick = 0;
+      test_list[test_index].test_results->pe_bandwidth_bytes_per_tick = 0;
+      test_list[test_index].test_results->overlap_percent = -1;
       test_list[test_index].test_results->iterations = iterations_count;
+      memset(test_list[test_index].test_results->histogram, 0, sizeof(test_list[test_index].test_results->histogram));
       transfered_count = 0;
 
       for(int idx=0; idx < iterations_count; idx++){
@@ -188,7 +314,10 @@ void run_tests(test_t *test_list, index_t test_length, iteration_data_t *iterati
         test_list[test_index].test_function(idx * test_data_scale_size, test_data_size, test_buffers, &transfered_count);
         ORB_read(timer_stop);
 
-        current_time = ORB_cycles_a(timer_stop, timer_start);
+        /* ORB_cycles_a() without wrapping when an interval is shorter than
+           the calibrated timer overhead */
+        current_time = ORB_cycles_u(timer_stop, timer_start);
+        current_time = current_time > ORB_AVGLAT ? current_time - ORB_AVGLAT : 0;
 
         test_list[test_index].test_results->accumulated_time_tick += current_time;
         if(test_list[test_index].test_results->min_time_tick > current_time) {
@@ -197,6 +326,7 @@ void run_tests(test_t *test_list, index_t test_length, iteration_data_t *iterati
         if(test_list[test_index].test_results->max_time_tick < current_time) {
           test_list[test_index].test_results->max_time_tick = current_time;
         }
+        record_time_tick(test_list[test_index].test_results, current_time);
         test_list[test_index].test_results->transfered_data_bytes += (transfered_count);
         transfered_count = 0;
         if(test_list[test_index].per_iteration_cleanup_function != NULL){
@@ -446,7 +576,16 @@ int main(int argc, char **argv){
   comm_t *shmem_system = NULL;
 
 #ifdef USE_SHMEM12
+#if defined(USE_THREADS) && SHOMS_SHMEM_AT_LEAST(1, 4)
+  if(threads_requested(argc, argv)){
+    int provided;
+    shmem_init_thread(SHMEM_THREAD_MULTIPLE, &provided);
+  } else {
+    shmem_init();
+  }
+#else
   shmem_init();
+#endif
 #else
   start_pes(0);
 #endif
@@ -464,6 +603,8 @@ int main(int argc, char **argv){
   wait_for_debugger();
 
   process_params(argc, argv, &input_parameters, &test_list, &test_length, &iterations, &iterations_length);
+  global_message_window = input_parameters.message_window;
+  init_traffic_pattern(&input_parameters);
 
   ORB_calibrate();
 
@@ -472,7 +613,12 @@ int main(int argc, char **argv){
     probe_system(shmem_system);
   }
 
-  if(input_parameters.affinity_test == 0){
+  if(input_parameters.max_threads != 0){
+    if(MY_PE == 0){
+      fprintf(input_parameters.output_file, "Running threaded tests\n");
+    }
+    run_threaded_tests(iterations, iterations_length, &input_parameters);
+  } else if(input_parameters.affinity_test == 0){
     if(MY_PE == 0){
       fprintf(input_parameters.output_file, "Running tests\n");
     }
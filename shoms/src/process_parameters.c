@@ -49,6 +49,9 @@ static struct option long_options[] = {
   {"time", required_argument, NULL, 10},
   {"input", required_argument, NULL, 11},
   {"affinity", no_argument, NULL, 12},
+  {"window", required_argument, NULL, 13},
+  {"pattern", required_argument, NULL, 14},
+  {"threads", required_argument, NULL, 15},
   {0,0,0,0}
 };
 
@@ -92,6 +95,19 @@ void print_help(){
   help_string("",                   "defines which tests to run. Tests are named after");
   help_string("",                   "their OpenSHMEM function. File is formated with one");
   help_string("",                   "test per line.");
+  help_string("--window NUMBER", "Number of non-blocking operations the message");
+  help_string("",                "rate tests (shmem_*_put_nbi, shmem_*_get_nbi)");
+  help_string("",                "issue between calls to shmem_quiet(). Default 64.");
+  help_string("--pattern NAME[:N]", "PEs the point to point tests run between:");
+  help_string("",                   "root (PE 0 to all others, default),");
+  help_string("",                   "pairwise[:k] (pe to pe^k), ring[:k] (pe to pe+k),");
+  help_string("",                   "alltoall, incast (all to PE 0) or random[:seed]");
+  help_string("",                   "(a random cyclic permutation).");
+  help_string("--threads NUMBER", "Runs the threaded injection tests instead of the");
+  help_string("",                 "test list: non-blocking puts, gets and atomic adds");
+  help_string("",                 "from 1, 2, 4, ... NUMBER threads per PE, with a");
+  help_string("",                 "private context per thread and with one shared");
+  help_string("",                 "context. Needs a THREADS=1 build.");
 
 }
 
@@ -208,6 +224,25 @@ void string_lower_case(char *buffer, size_t max_size){
 
 extern test_t *global_test_index;
 
+char *pattern_names[PATTERN_COUNT] = {"root", "pairwise", "ring", "alltoall", "incast", "random"};
+
+void process_pattern_string(char *input, parsed_options_t *set_options){
+  char *argument = strchr(input, ':');
+  size_t name_length = argument == NULL ? strlen(input) : (size_t)(argument - input);
+
+  for(int idx=0; idx < PATTERN_COUNT; idx++){
+    if(strlen(pattern_names[idx]) == name_length && strncmp(input, pattern_names[idx], name_length) == 0){
+      set_options->pattern = idx;
+      if(argument != NULL){
+        set_options->pattern_arg = process_string_to_number(argument + 1);
+      }
+      return;
+    }
+  }
+  fprintf(stderr, "Unknown traffic pattern %s\n", input);
+  abort();
+}
+
 void add_test(test_t *new_test, char *test_string, parsed_options_t *input_options){
   for(int idx=0; idx < MAX_TESTS; idx++){
     if(global_test_index[idx].name != NULL){
@@ -248,6 +283,21 @@ free_test_buffers:
   free(file_content);
 }
 
+/* shmem_init() comes before process_params(), so the thread level has to
+   be picked from a look at the raw arguments */
+int threads_requested(int argc, char **argv){
+  for(int idx=1; idx < argc; idx++){
+    char *arg = argv[idx];
+    if(arg[0] == '-' && arg[1] == '-'){
+      arg++;
+    }
+    if(strncmp(arg, "-threads", 8) == 0 && (arg[8] == '\0' || arg[8] == '=')){
+      return 1;
+    }
+  }
+  return 0;
+}
+
 //In our parameters processing, if the return of getopt_long_only() is 1 we exit, on 0 success, on -1 error
 void process_params(int argc, char **argv, parsed_options_t *set_options, test_t **test_list, index_t *test_length, iteration_data_t **iterations, index_t *iterations_length){
   int opt_index;
@@ -259,6 +309,9 @@ void process_params(int argc, char **argv, parsed_options_t *set_options, test_t
   memset(set_options, '\0', sizeof(parsed_options_t));
   set_options->maximum_size = MAXSIZE;
   set_options->minimum_size = MINSIZE;
+  set_options->message_window = DEFAULT_MESSAGE_WINDOW;
+  set_options->pattern = PATTERN_ROOT;
+  set_options->pattern_arg = 1;
   set_options->output_file = stdout;
 
   while(1){
@@ -317,6 +370,23 @@ void process_params(int argc, char **argv, parsed_options_t *set_options, test_t
           abort();
         }
         break;
+      case 13:
+        set_options->message_window = process_string_to_number(optarg);
+        if(set_options->message_window < 1){
+          fprintf(stderr, "The --window flag requires at least 1 operation!\n");
+          abort();
+        }
+        break;
+      case 14:
+        process_pattern_string(optarg, set_options);
+        break;
+      case 15:
+        set_options->max_threads = process_string_to_number(optarg);
+        if(set_options->max_threads < 1){
+          fprintf(stderr, "The --threads flag requires at least 1 thread!\n");
+          abort();
+        }
+        break;
       case '?':
         break;
       default:
@@ -43,60 +43,60 @@ void init_tests(){
   global_test_index[1]  = SET_SHOMS_TEST(shmem_local_write, init_distributed_32bit_bufffer, free_distributed_buffer, NULL, NULL, local);
   global_test_index[2]  = SET_SHOMS_TEST(shmalloc, init_shmalloc, cleanup_shmalloc, NULL, cleanup_per_iteration_shmalloc, global_no_bw);
   global_test_index[3]  = SET_SHOMS_TEST(shfree, NULL, NULL, init_distributed_32bit_bufffer, NULL, global_no_bw);
-  global_test_index[4]  = SET_SHOMS_TEST(shmem_short_p, init_distributed_short_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[5]  = SET_SHOMS_TEST(shmem_int_p, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[6]  = SET_SHOMS_TEST(shmem_long_p, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[7]  = SET_SHOMS_TEST(shmem_longlong_p, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[8]  = SET_SHOMS_TEST(shmem_float_p, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[9]  = SET_SHOMS_TEST(shmem_double_p, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[10] = SET_SHOMS_TEST(shmem_longdouble_p, init_distributed_longdouble_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[11] = SET_SHOMS_TEST(shmem_short_put, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[12] = SET_SHOMS_TEST(shmem_int_put, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[13] = SET_SHOMS_TEST(shmem_long_put, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[14] = SET_SHOMS_TEST(shmem_longlong_put, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[15] = SET_SHOMS_TEST(shmem_float_put, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[16] = SET_SHOMS_TEST(shmem_double_put, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[17] = SET_SHOMS_TEST(shmem_longdouble_put, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[18] = SET_SHOMS_TEST(shmem_put32, init_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[19] = SET_SHOMS_TEST(shmem_put64, init_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[20] = SET_SHOMS_TEST(shmem_put128, init_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[21] = SET_SHOMS_TEST(shmem_short_iput, init_strided_sym_and_local_short, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[22] = SET_SHOMS_TEST(shmem_int_iput, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[23] = SET_SHOMS_TEST(shmem_long_iput, init_strided_sym_and_local_long, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[24] = SET_SHOMS_TEST(shmem_longlong_iput, init_strided_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[25] = SET_SHOMS_TEST(shmem_float_iput, init_strided_sym_and_local_float, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[26] = SET_SHOMS_TEST(shmem_double_iput, init_strided_sym_and_local_double, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[27] = SET_SHOMS_TEST(shmem_longdouble_iput, init_strided_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[28] = SET_SHOMS_TEST(shmem_iput32, init_strided_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[29] = SET_SHOMS_TEST(shmem_iput64, init_strided_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[30] = SET_SHOMS_TEST(shmem_iput128, init_strided_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[31] = SET_SHOMS_TEST(shmem_short_g, init_distributed_short_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[32] = SET_SHOMS_TEST(shmem_int_g, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[33] = SET_SHOMS_TEST(shmem_long_g, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[34] = SET_SHOMS_TEST(shmem_longlong_g, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[35] = SET_SHOMS_TEST(shmem_float_g, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[36] = SET_SHOMS_TEST(shmem_double_g, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[37] = SET_SHOMS_TEST(shmem_longdouble_g, init_distributed_longdouble_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[38] = SET_SHOMS_TEST(shmem_short_get, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[39] = SET_SHOMS_TEST(shmem_int_get, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[40] = SET_SHOMS_TEST(shmem_long_get, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[41] = SET_SHOMS_TEST(shmem_longlong_get, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[42] = SET_SHOMS_TEST(shmem_float_get, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[43] = SET_SHOMS_TEST(shmem_double_get, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[44] = SET_SHOMS_TEST(shmem_longdouble_get, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[45] = SET_SHOMS_TEST(shmem_get32, init_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[46] = SET_SHOMS_TEST(shmem_get64, init_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[47] = SET_SHOMS_TEST(shmem_get128, init_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[48] = SET_SHOMS_TEST(shmem_short_iget, init_strided_sym_and_local_short, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[49] = SET_SHOMS_TEST(shmem_int_iget, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[50] = SET_SHOMS_TEST(shmem_long_iget, init_strided_sym_and_local_long, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[51] = SET_SHOMS_TEST(shmem_longlong_iget, init_strided_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[52] = SET_SHOMS_TEST(shmem_float_iget, init_strided_sym_and_local_float, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[53] = SET_SHOMS_TEST(shmem_double_iget, init_strided_sym_and_local_double, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[54] = SET_SHOMS_TEST(shmem_longdouble_iget, init_strided_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[55] = SET_SHOMS_TEST(shmem_iget32, init_strided_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[56] = SET_SHOMS_TEST(shmem_iget64, init_strided_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[57] = SET_SHOMS_TEST(shmem_iget128, init_strided_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, local);
+  global_test_index[4]  = SET_SHOMS_TEST(shmem_short_p, init_distributed_short_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[5]  = SET_SHOMS_TEST(shmem_int_p, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[6]  = SET_SHOMS_TEST(shmem_long_p, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[7]  = SET_SHOMS_TEST(shmem_longlong_p, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[8]  = SET_SHOMS_TEST(shmem_float_p, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[9]  = SET_SHOMS_TEST(shmem_double_p, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[10] = SET_SHOMS_TEST(shmem_longdouble_p, init_distributed_longdouble_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[11] = SET_SHOMS_TEST(shmem_short_put, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[12] = SET_SHOMS_TEST(shmem_int_put, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[13] = SET_SHOMS_TEST(shmem_long_put, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[14] = SET_SHOMS_TEST(shmem_longlong_put, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[15] = SET_SHOMS_TEST(shmem_float_put, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[16] = SET_SHOMS_TEST(shmem_double_put, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[17] = SET_SHOMS_TEST(shmem_longdouble_put, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[18] = SET_SHOMS_TEST(shmem_put32, init_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[19] = SET_SHOMS_TEST(shmem_put64, init_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[20] = SET_SHOMS_TEST(shmem_put128, init_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[21] = SET_SHOMS_TEST(shmem_short_iput, init_strided_sym_and_local_short, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[22] = SET_SHOMS_TEST(shmem_int_iput, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[23] = SET_SHOMS_TEST(shmem_long_iput, init_strided_sym_and_local_long, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[24] = SET_SHOMS_TEST(shmem_longlong_iput, init_strided_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[25] = SET_SHOMS_TEST(shmem_float_iput, init_strided_sym_and_local_float, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[26] = SET_SHOMS_TEST(shmem_double_iput, init_strided_sym_and_local_double, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[27] = SET_SHOMS_TEST(shmem_longdouble_iput, init_strided_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[28] = SET_SHOMS_TEST(shmem_iput32, init_strided_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[29] = SET_SHOMS_TEST(shmem_iput64, init_strided_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[30] = SET_SHOMS_TEST(shmem_iput128, init_strided_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[31] = SET_SHOMS_TEST(shmem_short_g, init_distributed_short_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[32] = SET_SHOMS_TEST(shmem_int_g, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[33] = SET_SHOMS_TEST(shmem_long_g, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[34] = SET_SHOMS_TEST(shmem_longlong_g, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[35] = SET_SHOMS_TEST(shmem_float_g, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[36] = SET_SHOMS_TEST(shmem_double_g, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[37] = SET_SHOMS_TEST(shmem_longdouble_g, init_distributed_longdouble_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[38] = SET_SHOMS_TEST(shmem_short_get, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[39] = SET_SHOMS_TEST(shmem_int_get, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[40] = SET_SHOMS_TEST(shmem_long_get, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[41] = SET_SHOMS_TEST(shmem_longlong_get, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[42] = SET_SHOMS_TEST(shmem_float_get, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[43] = SET_SHOMS_TEST(shmem_double_get, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[44] = SET_SHOMS_TEST(shmem_longdouble_get, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[45] = SET_SHOMS_TEST(shmem_get32, init_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[46] = SET_SHOMS_TEST(shmem_get64, init_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[47] = SET_SHOMS_TEST(shmem_get128, init_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[48] = SET_SHOMS_TEST(shmem_short_iget, init_strided_sym_and_local_short, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[49] = SET_SHOMS_TEST(shmem_int_iget, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[50] = SET_SHOMS_TEST(shmem_long_iget, init_strided_sym_and_local_long, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[51] = SET_SHOMS_TEST(shmem_longlong_iget, init_strided_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[52] = SET_SHOMS_TEST(shmem_float_iget, init_strided_sym_and_local_float, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[53] = SET_SHOMS_TEST(shmem_double_iget, init_strided_sym_and_local_double, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[54] = SET_SHOMS_TEST(shmem_longdouble_iget, init_strided_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[55] = SET_SHOMS_TEST(shmem_iget32, init_strided_sym_and_local_32bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[56] = SET_SHOMS_TEST(shmem_iget64, init_strided_sym_and_local_64bit, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[57] = SET_SHOMS_TEST(shmem_iget128, init_strided_sym_and_local_128bit, free_sym_and_local_t, NULL, NULL, p2p);
   global_test_index[58] = SET_SHOMS_TEST(shmem_short_and_to_all, init_collective_short, free_collective, NULL, NULL, global);
   global_test_index[59] = SET_SHOMS_TEST(shmem_int_and_to_all, init_collective_int, free_collective, NULL, NULL, global);
   global_test_index[60] = SET_SHOMS_TEST(shmem_long_and_to_all, init_collective_long, free_collective, NULL, NULL, global);
@@ -131,27 +131,27 @@ void init_tests(){
   global_test_index[89] = SET_SHOMS_TEST(shmem_collect64, init_shmem_collect64, free_shmem_broadcast, NULL, NULL, global);
   global_test_index[90] = SET_SHOMS_TEST(shmem_fcollect32, init_shmem_collect32, free_shmem_broadcast, NULL, NULL, global);
   global_test_index[91] = SET_SHOMS_TEST(shmem_fcollect64, init_shmem_collect64, free_shmem_broadcast, NULL, NULL, global);
-  global_test_index[92] = SET_SHOMS_TEST(shmem_int_swap, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[93] = SET_SHOMS_TEST(shmem_swap, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[94] = SET_SHOMS_TEST(shmem_long_swap, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[95] = SET_SHOMS_TEST(shmem_longlong_swap, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[96] = SET_SHOMS_TEST(shmem_float_swap, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[97] = SET_SHOMS_TEST(shmem_double_swap, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[98] = SET_SHOMS_TEST(shmem_int_cswap, init_distributed_int_buffer_zeroed, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[99] = SET_SHOMS_TEST(shmem_long_cswap, init_distributed_long_buffer_zeroed, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[100] = SET_SHOMS_TEST(shmem_longlong_cswap, init_distributed_longlong_buffer_zeroed, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[101] = SET_SHOMS_TEST(shmem_int_fadd, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[102] = SET_SHOMS_TEST(shmem_long_fadd, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[103] = SET_SHOMS_TEST(shmem_longlong_fadd, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);  
-  global_test_index[104] = SET_SHOMS_TEST(shmem_int_finc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[105] = SET_SHOMS_TEST(shmem_long_finc, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[106] = SET_SHOMS_TEST(shmem_longlong_finc, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[107] = SET_SHOMS_TEST(shmem_int_add, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[108] = SET_SHOMS_TEST(shmem_long_add, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[109] = SET_SHOMS_TEST(shmem_longlong_add, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[110] = SET_SHOMS_TEST(shmem_int_inc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[111] = SET_SHOMS_TEST(shmem_long_inc, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[112] = SET_SHOMS_TEST(shmem_longlong_inc, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, local);
+  global_test_index[92] = SET_SHOMS_TEST(shmem_int_swap, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[93] = SET_SHOMS_TEST(shmem_swap, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[94] = SET_SHOMS_TEST(shmem_long_swap, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[95] = SET_SHOMS_TEST(shmem_longlong_swap, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[96] = SET_SHOMS_TEST(shmem_float_swap, init_distributed_float_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[97] = SET_SHOMS_TEST(shmem_double_swap, init_distributed_double_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[98] = SET_SHOMS_TEST(shmem_int_cswap, init_distributed_int_buffer_zeroed, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[99] = SET_SHOMS_TEST(shmem_long_cswap, init_distributed_long_buffer_zeroed, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[100] = SET_SHOMS_TEST(shmem_longlong_cswap, init_distributed_longlong_buffer_zeroed, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[101] = SET_SHOMS_TEST(shmem_int_fadd, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[102] = SET_SHOMS_TEST(shmem_long_fadd, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[103] = SET_SHOMS_TEST(shmem_longlong_fadd, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);  
+  global_test_index[104] = SET_SHOMS_TEST(shmem_int_finc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[105] = SET_SHOMS_TEST(shmem_long_finc, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[106] = SET_SHOMS_TEST(shmem_longlong_finc, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[107] = SET_SHOMS_TEST(shmem_int_add, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[108] = SET_SHOMS_TEST(shmem_long_add, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[109] = SET_SHOMS_TEST(shmem_longlong_add, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[110] = SET_SHOMS_TEST(shmem_int_inc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[111] = SET_SHOMS_TEST(shmem_long_inc, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[112] = SET_SHOMS_TEST(shmem_longlong_inc, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
   global_test_index[113] = SET_SHOMS_TEST(shmem_wait, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, global_no_bw);
   global_test_index[114] = SET_SHOMS_TEST(shmem_short_wait, init_distributed_short_buffer, free_distributed_buffer, NULL, NULL, global_no_bw);
   global_test_index[115] = SET_SHOMS_TEST(shmem_int_wait, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, global_no_bw);
@@ -169,6 +169,88 @@ void init_tests(){
   global_test_index[126] = SET_SHOMS_TEST(shmem_init, NULL, NULL, init_per_iteration_shmem_init, NULL, global_no_bw);
   global_test_index[127] = SET_SHOMS_TEST(shmem_finalize, NULL, NULL, NULL, cleanup_per_iteration_shmem_finalize, global_no_bw);
 #endif
+#if SHOMS_SHMEM_AT_LEAST(1, 3)
+  global_test_index[128] = SET_SHOMS_TEST(shmem_short_put_nbi, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[129] = SET_SHOMS_TEST(shmem_int_put_nbi, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[130] = SET_SHOMS_TEST(shmem_long_put_nbi, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[131] = SET_SHOMS_TEST(shmem_longlong_put_nbi, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[132] = SET_SHOMS_TEST(shmem_float_put_nbi, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[133] = SET_SHOMS_TEST(shmem_double_put_nbi, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[134] = SET_SHOMS_TEST(shmem_longdouble_put_nbi, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[135] = SET_SHOMS_TEST(shmem_short_get_nbi, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[136] = SET_SHOMS_TEST(shmem_int_get_nbi, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[137] = SET_SHOMS_TEST(shmem_long_get_nbi, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[138] = SET_SHOMS_TEST(shmem_longlong_get_nbi, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[139] = SET_SHOMS_TEST(shmem_float_get_nbi, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[140] = SET_SHOMS_TEST(shmem_double_get_nbi, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[141] = SET_SHOMS_TEST(shmem_longdouble_get_nbi, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, rate);
+  global_test_index[142] = SET_SHOMS_TEST(shmem_putmem_overlap, init_shmem_putmem_overlap, free_sym_and_local_t, NULL, NULL, overlap);
+#endif
+  global_test_index[143] = SET_SHOMS_TEST(shmem_short_put_bidir, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[144] = SET_SHOMS_TEST(shmem_int_put_bidir, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[145] = SET_SHOMS_TEST(shmem_long_put_bidir, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[146] = SET_SHOMS_TEST(shmem_longlong_put_bidir, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[147] = SET_SHOMS_TEST(shmem_float_put_bidir, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[148] = SET_SHOMS_TEST(shmem_double_put_bidir, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[149] = SET_SHOMS_TEST(shmem_longdouble_put_bidir, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[150] = SET_SHOMS_TEST(shmem_short_get_bidir, init_sym_and_local_short, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[151] = SET_SHOMS_TEST(shmem_int_get_bidir, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[152] = SET_SHOMS_TEST(shmem_long_get_bidir, init_sym_and_local_long, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[153] = SET_SHOMS_TEST(shmem_longlong_get_bidir, init_sym_and_local_longlong, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[154] = SET_SHOMS_TEST(shmem_float_get_bidir, init_sym_and_local_float, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[155] = SET_SHOMS_TEST(shmem_double_get_bidir, init_sym_and_local_double, free_sym_and_local_t, NULL, NULL, bidir);
+  global_test_index[156] = SET_SHOMS_TEST(shmem_longdouble_get_bidir, init_sym_and_local_longdouble, free_sym_and_local_t, NULL, NULL, bidir);
+#if SHOMS_SHMEM_AT_LEAST(1, 4)
+  global_test_index[157] = SET_SHOMS_TEST(shmem_int_atomic_fetch, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[158] = SET_SHOMS_TEST(shmem_long_atomic_fetch, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[159] = SET_SHOMS_TEST(shmem_longlong_atomic_fetch, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[160] = SET_SHOMS_TEST(shmem_int_atomic_set, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[161] = SET_SHOMS_TEST(shmem_long_atomic_set, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[162] = SET_SHOMS_TEST(shmem_longlong_atomic_set, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[163] = SET_SHOMS_TEST(shmem_int_atomic_compare_swap, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[164] = SET_SHOMS_TEST(shmem_long_atomic_compare_swap, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[165] = SET_SHOMS_TEST(shmem_longlong_atomic_compare_swap, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[166] = SET_SHOMS_TEST(shmem_uint_atomic_fetch_and, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[167] = SET_SHOMS_TEST(shmem_ulong_atomic_fetch_and, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[168] = SET_SHOMS_TEST(shmem_ulonglong_atomic_fetch_and, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[169] = SET_SHOMS_TEST(shmem_uint_atomic_fetch_or, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[170] = SET_SHOMS_TEST(shmem_ulong_atomic_fetch_or, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[171] = SET_SHOMS_TEST(shmem_ulonglong_atomic_fetch_or, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[172] = SET_SHOMS_TEST(shmem_uint_atomic_fetch_xor, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[173] = SET_SHOMS_TEST(shmem_ulong_atomic_fetch_xor, init_distributed_long_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[174] = SET_SHOMS_TEST(shmem_ulonglong_atomic_fetch_xor, init_distributed_longlong_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[175] = SET_SHOMS_TEST(shmem_sync, init_shmem_sync, free_distributed_buffer, NULL, NULL, global_no_bw);
+  global_test_index[176] = SET_SHOMS_TEST(shmem_sync_all, NULL, NULL, NULL, NULL, global_no_bw);
+#endif
+#if SHOMS_SHMEM_AT_LEAST(1, 5)
+  global_test_index[177] = SET_SHOMS_TEST(shmem_putmem_signal, init_shmem_putmem_signal, free_signal_buffers, NULL, NULL, p2p);
+  global_test_index[178] = SET_SHOMS_TEST(shmem_putmem_signal_nbi, init_shmem_putmem_signal_nbi, free_signal_buffers, NULL, NULL, p2p);
+  global_test_index[179] = SET_SHOMS_TEST(shmem_signal_fetch, init_shmem_signal_fetch, free_signal_buffers, NULL, NULL, local);
+  global_test_index[180] = SET_SHOMS_TEST(shmem_broadcastmem, init_shmem_broadcast, free_shmem_broadcast, NULL, NULL, global);
+  global_test_index[181] = SET_SHOMS_TEST(shmem_alltoallmem, init_shmem_alltoallmem, free_shmem_broadcast, NULL, NULL, global);
+  global_test_index[182] = SET_SHOMS_TEST(shmem_team_sync, NULL, NULL, NULL, NULL, global_no_bw);
+  global_test_index[183] = SET_SHOMS_TEST(shmem_int_sum_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[184] = SET_SHOMS_TEST(shmem_long_sum_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[185] = SET_SHOMS_TEST(shmem_longlong_sum_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[186] = SET_SHOMS_TEST(shmem_int_prod_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[187] = SET_SHOMS_TEST(shmem_long_prod_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[188] = SET_SHOMS_TEST(shmem_longlong_prod_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[189] = SET_SHOMS_TEST(shmem_int_min_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[190] = SET_SHOMS_TEST(shmem_long_min_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[191] = SET_SHOMS_TEST(shmem_longlong_min_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[192] = SET_SHOMS_TEST(shmem_int_max_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[193] = SET_SHOMS_TEST(shmem_long_max_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[194] = SET_SHOMS_TEST(shmem_longlong_max_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[195] = SET_SHOMS_TEST(shmem_uint_and_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[196] = SET_SHOMS_TEST(shmem_ulong_and_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[197] = SET_SHOMS_TEST(shmem_ulonglong_and_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[198] = SET_SHOMS_TEST(shmem_uint_or_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[199] = SET_SHOMS_TEST(shmem_ulong_or_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[200] = SET_SHOMS_TEST(shmem_ulonglong_or_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+  global_test_index[201] = SET_SHOMS_TEST(shmem_uint_xor_reduce, init_collective_int, free_collective, NULL, NULL, global);
+  global_test_index[202] = SET_SHOMS_TEST(shmem_ulong_xor_reduce, init_collective_long, free_collective, NULL, NULL, global);
+  global_test_index[203] = SET_SHOMS_TEST(shmem_ulonglong_xor_reduce, init_collective_longlong, free_collective, NULL, NULL, global);
+#endif
 }
 
 index_t all_tests(test_t **tests_array){
@@ -183,18 +265,18 @@ index_t affinity_tests(test_t **tests_array){
   /*
   global_test_index[0]  = SET_SHOMS_TEST(shmem_local_read, init_distributed_32bit_bufffer, free_distributed_buffer, NULL, NULL, local);
   global_test_index[1]  = SET_SHOMS_TEST(shmem_local_write, init_distributed_32bit_bufffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[5]  = SET_SHOMS_TEST(shmem_int_p, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[12] = SET_SHOMS_TEST(shmem_int_put, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[22] = SET_SHOMS_TEST(shmem_int_iput, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[32] = SET_SHOMS_TEST(shmem_int_g, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[39] = SET_SHOMS_TEST(shmem_int_get, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[49] = SET_SHOMS_TEST(shmem_int_iget, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, local);
-  global_test_index[92] = SET_SHOMS_TEST(shmem_int_swap, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[98] = SET_SHOMS_TEST(shmem_int_cswap, init_distributed_int_buffer_zeroed, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[101] = SET_SHOMS_TEST(shmem_int_fadd, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[104] = SET_SHOMS_TEST(shmem_int_finc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[107] = SET_SHOMS_TEST(shmem_int_add, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
-  global_test_index[110] = SET_SHOMS_TEST(shmem_int_inc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, local);
+  global_test_index[5]  = SET_SHOMS_TEST(shmem_int_p, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[12] = SET_SHOMS_TEST(shmem_int_put, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[22] = SET_SHOMS_TEST(shmem_int_iput, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[32] = SET_SHOMS_TEST(shmem_int_g, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[39] = SET_SHOMS_TEST(shmem_int_get, init_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[49] = SET_SHOMS_TEST(shmem_int_iget, init_strided_sym_and_local_int, free_sym_and_local_t, NULL, NULL, p2p);
+  global_test_index[92] = SET_SHOMS_TEST(shmem_int_swap, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[98] = SET_SHOMS_TEST(shmem_int_cswap, init_distributed_int_buffer_zeroed, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[101] = SET_SHOMS_TEST(shmem_int_fadd, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[104] = SET_SHOMS_TEST(shmem_int_finc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[107] = SET_SHOMS_TEST(shmem_int_add, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
+  global_test_index[110] = SET_SHOMS_TEST(shmem_int_inc, init_distributed_int_buffer, free_distributed_buffer, NULL, NULL, p2p);
   global_test_index[123] = SET_SHOMS_TEST(shmem_clear_lock, init_distributed_long_buffer, free_distributed_buffer, init_per_iteration_shmem_clear_lock, NULL, global_no_bw);
   global_test_index[124] = SET_SHOMS_TEST(shmem_set_lock, init_distributed_long_buffer, free_distributed_buffer, NULL, cleanup_per_iteration_shmem_set_lock, global_no_bw);
   global_test_index[125] = SET_SHOMS_TEST(shmem_test_lock, init_distributed_long_buffer, free_distributed_buffer, NULL, cleanup_per_iteration_shmem_set_lock, global_no_bw);
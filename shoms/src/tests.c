@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <unistd.h>
+#include <math.h>
 
 /* Handy general utilities */
 
@@ -325,10 +326,59 @@ long pSync_max[_SHMEM_REDUCE_SYNC_SIZE];
 long pSync_sum[_SHMEM_REDUCE_SYNC_SIZE];
 int performance_data_initalized=0;
 
+long long pWork_hist[HIST_BUCKETS/2 + 1 > _SHMEM_REDUCE_MIN_WRKDATA_SIZE ?
+                    HIST_BUCKETS/2 + 1 : _SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+long pSync_hist[_SHMEM_REDUCE_SYNC_SIZE];
+
 long long max;
 long long min;
 long long bytes;
 long long accumulated_time;
+long long histogram[HIST_BUCKETS];
+
+static index_t histogram_bucket(ORB_tick_t time_tick){
+  int exponent;
+  if(time_tick < HIST_SUB_BUCKETS) return time_tick;
+  exponent = 63 - __builtin_clzll(time_tick);
+  return (exponent - HIST_SUB_BITS + 1) * HIST_SUB_BUCKETS + ((time_tick >> (exponent - HIST_SUB_BITS)) & (HIST_SUB_BUCKETS - 1));
+}
+
+static ORB_tick_t histogram_bucket_low(index_t bucket){
+  int exponent;
+  if(bucket < HIST_SUB_BUCKETS) return bucket;
+  exponent = bucket / HIST_SUB_BUCKETS + HIST_SUB_BITS - 1;
+  return ((ORB_tick_t)(HIST_SUB_BUCKETS + bucket % HIST_SUB_BUCKETS)) << (exponent - HIST_SUB_BITS);
+}
+
+void record_time_tick(test_results_t *test_results, ORB_tick_t time_tick){
+  test_results->histogram[histogram_bucket(time_tick)]++;
+}
+
+/* Middle of the bucket holding the given fraction of the samples, kept
+   within the measured min and max */
+ORB_tick_t percentile_time_tick(test_results_t *test_results, double fraction){
+  long long samples = 0, seen = 0, rank;
+  ORB_tick_t low, high, value;
+  index_t bucket;
+
+  for(bucket=0; bucket < HIST_BUCKETS; bucket++){
+    samples += test_results->histogram[bucket];
+  }
+  if(samples == 0) return 0;
+  rank = (long long)ceil(fraction * samples);
+  if(rank < 1) rank = 1;
+  for(bucket=0; bucket < HIST_BUCKETS - 1; bucket++){
+    seen += test_results->histogram[bucket];
+    if(seen >= rank) break;
+  }
+
+  low = histogram_bucket_low(bucket);
+  high = bucket == HIST_BUCKETS - 1 ? test_results->max_time_tick : histogram_bucket_low(bucket + 1) - 1;
+  value = low + (high - low) / 2;
+  if(value < test_results->min_time_tick) value = test_results->min_time_tick;
+  if(value > test_results->max_time_tick) value = test_results->max_time_tick;
+  return value;
+}
 
 void reduce_common_results(test_results_t *test_results){
   if(performance_data_initalized==0){
@@ -336,6 +386,7 @@ void reduce_common_results(test_results_t *test_results){
       pSync_min[idx]=_SHMEM_SYNC_VALUE;
       pSync_max[idx]=_SHMEM_SYNC_VALUE;
       pSync_sum[idx]=_SHMEM_SYNC_VALUE;
+      pSync_hist[idx]=_SHMEM_SYNC_VALUE;
     }
     shmem_barrier_all();
   }
@@ -350,6 +401,10 @@ void reduce_common_results(test_results_t *test_results){
   shmem_longlong_sum_to_all(&accumulated_time, &accumulated_time, 1, 0, 0, npes, pWork_sum, pSync_sum);
   shmem_longlong_min_to_all(&min, &min, 1, 0, 0, npes, pWork_min, pSync_min);
 
+  memcpy(histogram, test_results->histogram, sizeof(histogram));
+  shmem_longlong_sum_to_all(histogram, histogram, HIST_BUCKETS, 0, 0, npes, pWork_hist, pSync_hist);
+  memcpy(test_results->histogram, histogram, sizeof(histogram));
+
   test_results->max_time_tick = max;
   test_results->min_time_tick = min;
   test_results->accumulated_time_tick = accumulated_time;
@@ -370,66 +425,141 @@ void calculate_global_no_bw_performance(test_results_t *test_results){
   test_results->bandwidth_bytes_per_tick = (double)0.0;
 }
 
+long long pWork_pattern_sum[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+long long pWork_pattern_max[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+long pSync_pattern_sum[_SHMEM_REDUCE_SYNC_SIZE];
+long pSync_pattern_max[_SHMEM_REDUCE_SYNC_SIZE];
+long long pattern_sums[2];
+long long busiest_time;
+
+/*
+ * Point to point results under a traffic pattern with more than one
+ * sender.  PEs without targets are left out of the times; the aggregate
+ * bandwidth is the bytes of all PEs over the time of the busiest one.
+ */
+static void reduce_pattern_results(test_results_t *test_results, int sending){
+  int npes = N_PES;
+  long long senders;
+
+  if(performance_data_initalized==0){
+    for(int idx=0; idx < _SHMEM_REDUCE_SYNC_SIZE; idx++){
+      pSync_pattern_sum[idx]=_SHMEM_SYNC_VALUE;
+      pSync_pattern_max[idx]=_SHMEM_SYNC_VALUE;
+    }
+    shmem_barrier_all();
+  }
+
+  pattern_sums[0] = (long long)test_results->transfered_data_bytes;
+  pattern_sums[1] = sending ? 1 : 0;
+  busiest_time = (long long)test_results->accumulated_time_tick;
+  if(!sending){
+    test_results->min_time_tick = (ORB_tick_t)LLONG_MAX;
+    test_results->max_time_tick = 0;
+    test_results->accumulated_time_tick = 0;
+    memset(test_results->histogram, 0, sizeof(test_results->histogram));
+  }
+
+  reduce_common_results(test_results);
+  shmem_longlong_sum_to_all(pattern_sums, pattern_sums, 2, 0, 0, npes, pWork_pattern_sum, pSync_pattern_sum);
+  shmem_longlong_max_to_all(&busiest_time, &busiest_time, 1, 0, 0, npes, pWork_pattern_max, pSync_pattern_max);
+
+  senders = pattern_sums[1] > 0 ? pattern_sums[1] : 1;
+  test_results->transfered_data_bytes = pattern_sums[0];
+  test_results->avg_time_tick = (double)test_results->accumulated_time_tick / (double)(test_results->iterations * senders);
+  test_results->bandwidth_bytes_per_tick = (double)pattern_sums[0] / (double)busiest_time;
+  test_results->pe_bandwidth_bytes_per_tick = test_results->bandwidth_bytes_per_tick / (double)senders;
+  test_results->messages_per_tick = (double)(test_results->iterations * senders) / (double)busiest_time;
+}
+
+void calculate_p2p_performance(test_results_t *test_results){
+  if(global_pattern == PATTERN_ROOT){
+    calculate_local_performance(test_results);
+    test_results->pe_bandwidth_bytes_per_tick = test_results->bandwidth_bytes_per_tick;
+  } else {
+    reduce_pattern_results(test_results, TARGET_COUNT > 0);
+    test_results->messages_per_tick = (double)0.0;
+  }
+}
+
+/* Each sending PE issues global_message_window operations per iteration */
+void calculate_rate_performance(test_results_t *test_results){
+  if(global_pattern == PATTERN_ROOT){
+    calculate_p2p_performance(test_results);
+    if(TARGET_COUNT > 0){
+      test_results->messages_per_tick = (double)(test_results->iterations * global_message_window) / (double)(test_results->accumulated_time_tick);
+    }
+  } else {
+    reduce_pattern_results(test_results, TARGET_COUNT > 0);
+    test_results->messages_per_tick *= (double)global_message_window;
+  }
+}
+
+/* Both PEs of each pair inject, whatever the traffic pattern */
+void calculate_bidir_performance(test_results_t *test_results){
+  reduce_pattern_results(test_results, BIDIR_PARTNER >= 0);
+  test_results->messages_per_tick = (double)0.0;
+}
+
 
 #define elemental_put_type(type) \
 index_t test_shmem_ ## type ## _p(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){ \
-  if(MY_PE != 0) return 1; \
+  if(TARGET_COUNT == 0) return 1; \
   type *test_buffer = (type *)buffers; \
   type value = 0; \
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type)); \
   for(index_t idx=0; idx < num_indexes; idx++){ \
-    for(int jdx=0; jdx < REMOTE_PES; jdx++){\
-      shmem_ ## type ## _p(&(test_buffer[idx]), value, jdx+1); \
+    for(int jdx=0; jdx < TARGET_COUNT; jdx++){\
+      shmem_ ## type ## _p(&(test_buffer[idx]), value, TARGET_PE(jdx)); \
     }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;  \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;  \
   shmem_quiet();\
   return 0;\
 }
 
 #define elemental_get_type(type) \
   index_t test_shmem_ ## type ## _g(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){ \
-  if(MY_PE != 0) return 1; \
+  if(TARGET_COUNT == 0) return 1; \
   type *test_buffer = (type *)buffers; \
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type)); \
   type value = 0;\
   for(index_t idx=0; idx < num_indexes; idx++){ \
-    for(int jdx=0; jdx < REMOTE_PES; jdx++){\
-      value += shmem_ ## type ## _g(&(test_buffer[idx]), jdx+1); \
+    for(int jdx=0; jdx < TARGET_COUNT; jdx++){\
+      value += shmem_ ## type ## _g(&(test_buffer[idx]), TARGET_PE(jdx)); \
     }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT; \
   return value;\
 }
 
 #define elemental_put_type2(type_a, type_b)                                    \
 index_t test_shmem_ ## type_a ## type_b ## _p(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){ \
-  if(MY_PE != 0) return 1; \
+  if(TARGET_COUNT == 0) return 1; \
   type_a type_b *test_buffer = (type_a type_b *)buffers; \
   type_a type_b value = 0; \
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b)); \
   for(index_t idx=0; idx < num_indexes; idx++){ \
-    for(int jdx=0; jdx < REMOTE_PES; jdx++){\
-      shmem_ ## type_a ## type_b ## _p(&(test_buffer[idx]), value, jdx+1); \
+    for(int jdx=0; jdx < TARGET_COUNT; jdx++){\
+      shmem_ ## type_a ## type_b ## _p(&(test_buffer[idx]), value, TARGET_PE(jdx)); \
     }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   shmem_quiet();\
   return 0;\
 }
 
 #define elemental_get_type2(type_a, type_b)                                    \
   index_t test_shmem_ ## type_a ## type_b ## _g(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){ \
-  if(MY_PE != 0) return 1; \
+  if(TARGET_COUNT == 0) return 1; \
   type_a type_b *test_buffer = (type_a type_b *)buffers; \
   type_a type_b value = 0; \
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b)); \
   for(index_t idx=0; idx < num_indexes; idx++){ \
-    for(int jdx=0; jdx < REMOTE_PES; jdx++){\
-      value += shmem_ ## type_a ## type_b ## _g(&(test_buffer[idx]), jdx+1); \
+    for(int jdx=0; jdx < TARGET_COUNT; jdx++){\
+      value += shmem_ ## type_a ## type_b ## _g(&(test_buffer[idx]), TARGET_PE(jdx)); \
     }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   return value;\
 }
 
@@ -438,207 +568,410 @@ declare_with_common_types(elemental_get_type)
 
 #define block_put_type(type) \
 index_t test_shmem_ ## type ## _put(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type *shmem_buffer = (type*)test_buffers->symetric;\
   type *local_buffer = (type*)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type ## _put(shmem_buffer, local_buffer, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type ## _put(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT; \
   shmem_quiet();\
   return 0;\
 }
 
 #define block_put_type2(type_a, type_b)                                         \
   index_t test_shmem_ ## type_a ## type_b ## _put(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
   type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type_a ## type_b ## _put(shmem_buffer, local_buffer, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type_a ## type_b ## _put(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   shmem_quiet();\
   return 0;\
   }
 
 #define block_get_type(type) \
 index_t test_shmem_ ## type ## _get(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type *shmem_buffer = (type*)test_buffers->symetric;\
   type *local_buffer = (type*)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type ## _get(local_buffer, shmem_buffer, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type ## _get(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT; \
   return 0;\
 }
 
 #define block_get_type2(type_a, type_b)                                         \
   index_t test_shmem_ ## type_a ## type_b ## _get(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
   type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type_a ## type_b ## _get(local_buffer, shmem_buffer, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type_a ## type_b ## _get(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   return 0;\
 }
 
 declare_with_common_types(block_put_type)
 declare_with_common_types(block_get_type)
 
+#if SHOMS_SHMEM_AT_LEAST(1, 3)
+/* Message rate: a window of non-blocking operations spread round robin
+   over the remote PEs, completed by a single shmem_quiet() */
+#define nbi_put_rate_type(type) \
+index_t test_shmem_ ## type ## _put_nbi(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type *shmem_buffer = (type*)test_buffers->symetric;\
+  type *local_buffer = (type*)test_buffers->local;\
+  for(index_t idx=0; idx < global_message_window; idx++){\
+    shmem_ ## type ## _put_nbi(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx % TARGET_COUNT)); \
+  }\
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type) * global_message_window; \
+  return 0;\
+}
+
+#define nbi_put_rate_type2(type_a, type_b)                                      \
+index_t test_shmem_ ## type_a ## type_b ## _put_nbi(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
+  type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
+  for(index_t idx=0; idx < global_message_window; idx++){\
+    shmem_ ## type_a ## type_b ## _put_nbi(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx % TARGET_COUNT)); \
+  }\
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * global_message_window; \
+  return 0;\
+}
+
+#define nbi_get_rate_type(type) \
+index_t test_shmem_ ## type ## _get_nbi(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type *shmem_buffer = (type*)test_buffers->symetric;\
+  type *local_buffer = (type*)test_buffers->local;\
+  for(index_t idx=0; idx < global_message_window; idx++){\
+    shmem_ ## type ## _get_nbi(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx % TARGET_COUNT)); \
+  }\
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type) * global_message_window; \
+  return 0;\
+}
+
+#define nbi_get_rate_type2(type_a, type_b)                                      \
+index_t test_shmem_ ## type_a ## type_b ## _get_nbi(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
+  type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
+  for(index_t idx=0; idx < global_message_window; idx++){\
+    shmem_ ## type_a ## type_b ## _get_nbi(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx % TARGET_COUNT)); \
+  }\
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * global_message_window; \
+  return 0;\
+}
+
+declare_with_common_types(nbi_put_rate_type)
+declare_with_common_types(nbi_get_rate_type)
+
+/*
+ * Overlap: shmem_putmem_nbi() of the message, a busy loop as long as the
+ * transfer alone takes, then shmem_quiet().  The init function times the
+ * transfer and sizes the loop; if the library progresses the put while the
+ * CPU is busy the iteration takes about as long as the longer of the two.
+ */
+#define OVERLAP_CALIBRATION_RUNS 20
+
+static index_t overlap_compute_loops;
+static double overlap_comm_tick;
+static double overlap_compute_tick;
+
+static void busy_loop(index_t loops){
+  volatile index_t counter = 0;
+  for(index_t idx=0; idx < loops; idx++){
+    counter += idx;
+  }
+}
+
+static double time_busy_loop(index_t loops){
+  ORB_t timer_start, timer_stop;
+  ORB_tick_t total = 0;
+  for(int idx=0; idx < OVERLAP_CALIBRATION_RUNS; idx++){
+    ORB_read(timer_start);
+    busy_loop(loops);
+    ORB_read(timer_stop);
+    total += ORB_cycles_u(timer_stop, timer_start);
+  }
+  return (double)total / OVERLAP_CALIBRATION_RUNS;
+}
+
+void init_shmem_putmem_overlap(void **buffers, index_t size){
+  ORB_t timer_start, timer_stop;
+  ORB_tick_t total = 0;
+  sym_and_local_t *test_buffers;
+  double loop_tick;
+
+  init_sym_and_local_t(buffers, size, sizeof(char));
+  overlap_compute_loops = 0;
+  overlap_comm_tick = overlap_compute_tick = 0;
+  if(TARGET_COUNT == 0) return;
+
+  test_buffers = (sym_and_local_t *)*buffers;
+  for(int idx=0; idx < OVERLAP_CALIBRATION_RUNS; idx++){
+    ORB_read(timer_start);
+    shmem_putmem_nbi(test_buffers->symetric, test_buffers->local, size, TARGET_PE(0));
+    shmem_quiet();
+    ORB_read(timer_stop);
+    total += ORB_cycles_u(timer_stop, timer_start);
+  }
+  overlap_comm_tick = (double)total / OVERLAP_CALIBRATION_RUNS;
+
+  loop_tick = time_busy_loop(1 << 16) / (double)(1 << 16);
+  overlap_compute_loops = (index_t)(overlap_comm_tick / loop_tick);
+  overlap_compute_tick = time_busy_loop(overlap_compute_loops);
+}
+
+index_t test_shmem_putmem_overlap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  if(TARGET_COUNT == 0) return 1;
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
+  shmem_putmem_nbi(test_buffers->symetric, test_buffers->local, test_size, TARGET_PE(0));
+  busy_loop(overlap_compute_loops);
+  shmem_quiet();
+  *bytes_transfered = test_size;
+  return 0;
+}
+
+/* 100% when the iteration took only as long as the longer of transfer
+   and compute, 0% when it took their sum */
+void calculate_overlap_performance(test_results_t *test_results){
+  double shorter, overlap;
+
+  calculate_p2p_performance(test_results);
+  if(TARGET_COUNT == 0 || overlap_comm_tick == 0 || overlap_compute_tick == 0) return;
+
+  shorter = overlap_comm_tick < overlap_compute_tick ? overlap_comm_tick : overlap_compute_tick;
+  overlap = 100.0 * (overlap_comm_tick + overlap_compute_tick - test_results->avg_time_tick) / shorter;
+  if(overlap < 0) overlap = 0;
+  if(overlap > 100) overlap = 100;
+  test_results->overlap_percent = overlap;
+}
+#endif
+
+/* Bidirectional: PE p and PE p^1 put to (get from) each other at once */
+#define bidir_put_type(type) \
+index_t test_shmem_ ## type ## _put_bidir(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(BIDIR_PARTNER < 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type *shmem_buffer = (type*)test_buffers->symetric;\
+  type *local_buffer = (type*)test_buffers->local;\
+  shmem_ ## type ## _put(shmem_buffer, local_buffer, num_indexes, BIDIR_PARTNER); \
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type); \
+  return 0;\
+}
+
+#define bidir_put_type2(type_a, type_b)                                         \
+index_t test_shmem_ ## type_a ## type_b ## _put_bidir(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(BIDIR_PARTNER < 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
+  type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
+  shmem_ ## type_a ## type_b ## _put(shmem_buffer, local_buffer, num_indexes, BIDIR_PARTNER); \
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type_a type_b); \
+  return 0;\
+}
+
+#define bidir_get_type(type) \
+index_t test_shmem_ ## type ## _get_bidir(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(BIDIR_PARTNER < 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type *shmem_buffer = (type*)test_buffers->symetric;\
+  type *local_buffer = (type*)test_buffers->local;\
+  shmem_ ## type ## _get(local_buffer, shmem_buffer, num_indexes, BIDIR_PARTNER); \
+  *bytes_transfered = num_indexes * sizeof(type); \
+  return 0;\
+}
+
+#define bidir_get_type2(type_a, type_b)                                         \
+index_t test_shmem_ ## type_a ## type_b ## _get_bidir(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(BIDIR_PARTNER < 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
+  sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
+  type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
+  type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
+  shmem_ ## type_a ## type_b ## _get(local_buffer, shmem_buffer, num_indexes, BIDIR_PARTNER); \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b); \
+  return 0;\
+}
+
+declare_with_common_types(bidir_put_type)
+declare_with_common_types(bidir_get_type)
+
 index_t test_shmem_put32(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int32_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int32_t *shmem_buffer = (int32_t*)test_buffers->symetric;
   int32_t *local_buffer = (int32_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_put32(shmem_buffer, local_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_put32(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int32_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int32_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_put64(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int64_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int64_t *shmem_buffer = (int64_t*)test_buffers->symetric;
   int64_t *local_buffer = (int64_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_put64(shmem_buffer, local_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_put64(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int64_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int64_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_put128(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int128_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int128_t *shmem_buffer = (int128_t*)test_buffers->symetric;
   int128_t *local_buffer = (int128_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_put128(shmem_buffer, local_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_put128(shmem_buffer, local_buffer, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int128_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int128_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_get32(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int32_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int32_t *shmem_buffer = (int32_t*)test_buffers->symetric;
   int32_t *local_buffer = (int32_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_get32(local_buffer, shmem_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_get32(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int32_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int32_t) * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_get64(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int64_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int64_t *shmem_buffer = (int64_t*)test_buffers->symetric;
   int64_t *local_buffer = (int64_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_get64(local_buffer, shmem_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_get64(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int64_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int64_t) * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_get128(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int128_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int128_t *shmem_buffer = (int128_t*)test_buffers->symetric;
   int128_t *local_buffer = (int128_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_get128(local_buffer, shmem_buffer, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_get128(local_buffer, shmem_buffer, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int128_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int128_t) * TARGET_COUNT;
   return 0;
 }
 
 #define strided_put_type(type)\
   index_t test_shmem_ ## type ## _iput(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type *shmem_buffer = (type*)test_buffers->symetric;\
   type *local_buffer = (type*)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type ## _iput(shmem_buffer, local_buffer, 2, 2, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type ## _iput(shmem_buffer, local_buffer, 2, 2, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT; \
   shmem_quiet();\
   return 0;\
 }
 
 #define strided_get_type(type)\
   index_t test_shmem_ ## type ## _iget(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type *shmem_buffer = (type*)test_buffers->symetric;\
   type *local_buffer = (type*)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type ## _iget(local_buffer, shmem_buffer, 2, 2, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type ## _iget(local_buffer, shmem_buffer, 2, 2, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT; \
   return 0;\
 }
 
 #define strided_put_type2(type_a, type_b)                                         \
 index_t test_shmem_ ## type_a ## type_b ## _iput(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
   type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type_a ## type_b ## _iput(shmem_buffer, local_buffer, 2, 2, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type_a ## type_b ## _iput(shmem_buffer, local_buffer, 2, 2, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   shmem_quiet();\
   return 0;\
 }
 
 #define strided_get_type2(type_a, type_b)                                         \
 index_t test_shmem_ ## type_a ## type_b ## _iget(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type_a type_b));\
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;\
   type_a type_b *shmem_buffer = (type_a type_b *)test_buffers->symetric;\
   type_a type_b *local_buffer = (type_a type_b *)test_buffers->local;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
-    shmem_ ## type_a ## type_b ## _iget(local_buffer, shmem_buffer, 2, 2, num_indexes, idx+1); \
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    shmem_ ## type_a ## type_b ## _iget(local_buffer, shmem_buffer, 2, 2, num_indexes, TARGET_PE(idx)); \
   }\
-  *bytes_transfered = num_indexes * sizeof(type_a type_b) * REMOTE_PES; \
+  *bytes_transfered = num_indexes * sizeof(type_a type_b) * TARGET_COUNT; \
   return 0;\
 }
 
@@ -646,89 +979,89 @@ declare_with_common_types(strided_put_type)
 declare_with_common_types(strided_get_type)
 
 index_t test_shmem_iput32(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int32_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int32_t *shmem_buffer = (int32_t*)test_buffers->symetric;
   int32_t *local_buffer = (int32_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iput32(shmem_buffer, local_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iput32(shmem_buffer, local_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int32_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int32_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_iput64(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int64_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int64_t *shmem_buffer = (int64_t*)test_buffers->symetric;
   int64_t *local_buffer = (int64_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iput64(shmem_buffer, local_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iput64(shmem_buffer, local_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int64_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int64_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_iput128(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int128_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int128_t *shmem_buffer = (int128_t*)test_buffers->symetric;
   int128_t *local_buffer = (int128_t*)test_buffers->local;
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iput128(shmem_buffer, local_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iput128(shmem_buffer, local_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
 
-  *bytes_transfered = num_indexes * sizeof(int128_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int128_t) * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
 
 index_t test_shmem_iget32(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int32_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int32_t *shmem_buffer = (int32_t*)test_buffers->symetric;
   int32_t *local_buffer = (int32_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iget32(local_buffer, shmem_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iget32(local_buffer, shmem_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int32_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int32_t) * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_iget64(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int64_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int64_t *shmem_buffer = (int64_t*)test_buffers->symetric;
   int64_t *local_buffer = (int64_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iget64(local_buffer, shmem_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iget64(local_buffer, shmem_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int64_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int64_t) * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_iget128(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(int128_t));
   sym_and_local_t *test_buffers = (sym_and_local_t *)buffers;
   int128_t *shmem_buffer = (int128_t*)test_buffers->symetric;
   int128_t *local_buffer = (int128_t*)test_buffers->local;
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_iget128(local_buffer, shmem_buffer, 2, 2, num_indexes, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_iget128(local_buffer, shmem_buffer, 2, 2, num_indexes, TARGET_PE(idx));
   }
-  *bytes_transfered = num_indexes * sizeof(int128_t) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(int128_t) * TARGET_COUNT;
   return 0;
 }
 
@@ -777,16 +1110,16 @@ collective_tests_ops(shmem_collective)
 
 #define cswap_type(type)\
   index_t test_shmem_ ## type ## _cswap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
   type new_value=0;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
   for(index_t jdx=0; jdx < num_indexes; jdx++){\
-    new_value = shmem_ ## type ## _cswap(&(buffer[jdx]), (type)0, new_value, idx+1); \
+    new_value = shmem_ ## type ## _cswap(&(buffer[jdx]), (type)0, new_value, TARGET_PE(idx)); \
   }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return 0;\
   }
 
@@ -794,31 +1127,31 @@ cswap_type(int)
 cswap_type(long)
 
 index_t test_shmem_longlong_cswap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
   long long new_value=0;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      new_value = shmem_longlong_cswap(&(buffer[jdx]), (long long)0, new_value, idx+1); 
+      new_value = shmem_longlong_cswap(&(buffer[jdx]), (long long)0, new_value, TARGET_PE(idx)); 
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return 0;
 }
 
 #define fadd_type(type)\
   index_t test_shmem_ ## type ## _fadd(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
   type new_value=0;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
   for(index_t jdx=0; jdx < num_indexes; jdx++){\
-  new_value = shmem_ ## type ## _fadd(&(buffer[jdx]), (type)0, idx+1); \
+  new_value = shmem_ ## type ## _fadd(&(buffer[jdx]), (type)0, TARGET_PE(idx)); \
   }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return new_value;\
   }
 
@@ -826,31 +1159,31 @@ fadd_type(int)
 fadd_type(long)
 
 index_t test_shmem_longlong_fadd(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
   long long new_value=0;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      new_value = shmem_longlong_fadd(&(buffer[jdx]), (long long)0, idx+1);
+      new_value = shmem_longlong_fadd(&(buffer[jdx]), (long long)0, TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return new_value;
 }
 
 #define finc_type(type)\
   index_t test_shmem_ ## type ## _finc(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
   type new_value=0;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
   for(index_t jdx=0; jdx < num_indexes; jdx++){\
-  new_value = shmem_ ## type ## _finc(&(buffer[jdx]), idx+1); \
+  new_value = shmem_ ## type ## _finc(&(buffer[jdx]), TARGET_PE(idx)); \
   }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return new_value;\
   }
 
@@ -858,30 +1191,30 @@ finc_type(int)
 finc_type(long)
 
 index_t test_shmem_longlong_finc(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
   long long new_value=0;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      new_value = shmem_longlong_finc(&(buffer[jdx]), idx+1);
+      new_value = shmem_longlong_finc(&(buffer[jdx]), TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return new_value;
 }
 
 #define add_type(type)\
   index_t test_shmem_ ## type ## _add(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
   for(index_t jdx=0; jdx < num_indexes; jdx++){\
-  shmem_ ## type ## _add(&(buffer[jdx]), (type)0, idx+1); \
+  shmem_ ## type ## _add(&(buffer[jdx]), (type)0, TARGET_PE(idx)); \
   }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return 0;\
   }
 
@@ -889,29 +1222,29 @@ add_type(int)
 add_type(long)
 
 index_t test_shmem_longlong_add(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      shmem_longlong_add(&(buffer[jdx]), (long long)0, idx+1);
+      shmem_longlong_add(&(buffer[jdx]), (long long)0, TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return 0;
 }
 
 #define inc_type(type)\
   index_t test_shmem_ ## type ## _inc(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
   for(index_t jdx=0; jdx < num_indexes; jdx++){\
-  shmem_ ## type ## _inc(&(buffer[jdx]), idx+1); \
+  shmem_ ## type ## _inc(&(buffer[jdx]), TARGET_PE(idx)); \
   }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return 0;\
   }
 
@@ -919,15 +1252,15 @@ inc_type(int)
 inc_type(long)
 
 index_t test_shmem_longlong_inc(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      shmem_longlong_inc(&(buffer[jdx]), idx+1);
+      shmem_longlong_inc(&(buffer[jdx]), TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return 0;
 }
 
@@ -1021,16 +1354,16 @@ index_t test_shmem_longlong_wait_until(index_t test_start, index_t test_size, vo
 
 #define swap_type(type)\
 index_t test_shmem_ ## type ## _swap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
-  if(MY_PE != 0) return 1;\
+  if(TARGET_COUNT == 0) return 1;\
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
   type *buffer = (type *)buffers;\
   type new_value=0;\
-  for(int idx=0; idx < REMOTE_PES; idx++){\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
     for(index_t jdx=0; jdx < num_indexes; jdx++){\
-      new_value = shmem_ ## type ## _swap(&(buffer[jdx]), new_value, idx+1);\
+      new_value = shmem_ ## type ## _swap(&(buffer[jdx]), new_value, TARGET_PE(idx));\
     }\
   }\
-  *bytes_transfered = num_indexes * sizeof(type) * REMOTE_PES;\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
   return 0;\
 }
 
@@ -1040,30 +1373,30 @@ swap_type(float)
 swap_type(double)
 
 index_t test_shmem_swap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long));
   long *buffer = (long *)buffers;
   long new_value=0;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      new_value = shmem_swap(&(buffer[jdx]), new_value, idx+1);
+      new_value = shmem_swap(&(buffer[jdx]), new_value, TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long) * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_longlong_swap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0) return 1;
+  if(TARGET_COUNT == 0) return 1;
   index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(long long));
   long long *buffer = (long long *)buffers;
   long long new_value=0;
-  for(int idx=0; idx < REMOTE_PES; idx++){
+  for(int idx=0; idx < TARGET_COUNT; idx++){
     for(index_t jdx=0; jdx < num_indexes; jdx++){
-      new_value = shmem_longlong_swap(&(buffer[jdx]), new_value, idx+1);
+      new_value = shmem_longlong_swap(&(buffer[jdx]), new_value, TARGET_PE(idx));
     }
   }
-  *bytes_transfered = num_indexes * sizeof(long long) * REMOTE_PES;
+  *bytes_transfered = num_indexes * sizeof(long long) * TARGET_COUNT;
   return 0;
 }
 
@@ -1317,28 +1650,28 @@ index_t test_shmem_fcollect64(index_t test_start, index_t test_size, void *buffe
 }
 
 index_t test_shmem_getmem(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0){
+  if(TARGET_COUNT == 0){
     return 1;
   }
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_getmem(buffers, buffers, test_size, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_getmem(buffers, buffers, test_size, TARGET_PE(idx));
   }
 
-  *bytes_transfered = test_size * REMOTE_PES;
+  *bytes_transfered = test_size * TARGET_COUNT;
   return 0;
 }
 
 index_t test_shmem_putmem(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
-  if(MY_PE != 0){
+  if(TARGET_COUNT == 0){
     return 1;
   }
 
-  for(int idx=0; idx < REMOTE_PES; idx++){
-    shmem_putmem(buffers, buffers, test_size, idx+1);
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_putmem(buffers, buffers, test_size, TARGET_PE(idx));
   }
 
-  *bytes_transfered = test_size * REMOTE_PES;
+  *bytes_transfered = test_size * TARGET_COUNT;
   shmem_quiet();
   return 0;
 }
@@ -1448,3 +1781,219 @@ void cleanup_per_iteration_shmem_finalize(void *buffer){
 }
 
 #endif
+
+#if SHOMS_SHMEM_AT_LEAST(1, 4)
+
+/* OpenSHMEM 1.4 atomics, same access pattern as the 1.1 era AMO tests */
+#define atomic_fetch_type(type, name)\
+index_t test_shmem_ ## name ## _atomic_fetch(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  type *buffer = (type *)buffers;\
+  type value = 0;\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    for(index_t jdx=0; jdx < num_indexes; jdx++){\
+      value += shmem_ ## name ## _atomic_fetch(&(buffer[jdx]), TARGET_PE(idx));\
+    }\
+  }\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
+  return (index_t)value;\
+}
+
+#define atomic_set_type(type, name)\
+index_t test_shmem_ ## name ## _atomic_set(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  type *buffer = (type *)buffers;\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    for(index_t jdx=0; jdx < num_indexes; jdx++){\
+      shmem_ ## name ## _atomic_set(&(buffer[jdx]), (type)0, TARGET_PE(idx));\
+    }\
+  }\
+  shmem_quiet();\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
+  return 0;\
+}
+
+#define atomic_compare_swap_type(type, name)\
+index_t test_shmem_ ## name ## _atomic_compare_swap(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  type *buffer = (type *)buffers;\
+  type new_value = 0;\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    for(index_t jdx=0; jdx < num_indexes; jdx++){\
+      new_value = shmem_ ## name ## _atomic_compare_swap(&(buffer[jdx]), (type)0, new_value, TARGET_PE(idx));\
+    }\
+  }\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
+  return 0;\
+}
+
+#define atomic_fetch_bitwise_type(type, name, op)\
+index_t test_shmem_ ## name ## _atomic_fetch_ ## op(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  if(TARGET_COUNT == 0) return 1;\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  type *buffer = (type *)buffers;\
+  type value = 0;\
+  for(int idx=0; idx < TARGET_COUNT; idx++){\
+    for(index_t jdx=0; jdx < num_indexes; jdx++){\
+      value ^= shmem_ ## name ## _atomic_fetch_ ## op(&(buffer[jdx]), (type)0, TARGET_PE(idx));\
+    }\
+  }\
+  *bytes_transfered = num_indexes * sizeof(type) * TARGET_COUNT;\
+  return (index_t)value;\
+}
+
+#define atomic_standard_types(atomic_function)\
+  atomic_function(int, int)\
+  atomic_function(long, long)\
+  atomic_function(long long, longlong)
+
+#define atomic_bitwise_types(atomic_function, op)\
+  atomic_function(unsigned int, uint, op)\
+  atomic_function(unsigned long, ulong, op)\
+  atomic_function(unsigned long long, ulonglong, op)
+
+atomic_standard_types(atomic_fetch_type)
+atomic_standard_types(atomic_set_type)
+atomic_standard_types(atomic_compare_swap_type)
+atomic_bitwise_types(atomic_fetch_bitwise_type, and)
+atomic_bitwise_types(atomic_fetch_bitwise_type, or)
+atomic_bitwise_types(atomic_fetch_bitwise_type, xor)
+
+void init_shmem_sync(void **buffers, index_t size){
+  long *pSync = allocate_distributed_buffer(_SHMEM_BARRIER_SYNC_SIZE * sizeof(long), sizeof(long));
+  for(int idx=0; idx < _SHMEM_BARRIER_SYNC_SIZE; idx++){
+    pSync[idx] = _SHMEM_SYNC_VALUE;
+  }
+  shmem_barrier_all();
+  *buffers = (void *)pSync;
+}
+
+index_t test_shmem_sync(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  shmem_sync(0, 0, N_PES, (long *)buffers);
+  *bytes_transfered = 0;
+  return 0;
+}
+
+index_t test_shmem_sync_all(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  shmem_sync_all();
+  *bytes_transfered = 0;
+  return 0;
+}
+
+#endif
+
+#if SHOMS_SHMEM_AT_LEAST(1, 5)
+
+/* Put with signal: the data and a signal word update in one operation */
+void init_signal_buffers(void **buffers, index_t size){
+  signal_buffers_t *test_buffers = malloc(sizeof(signal_buffers_t));
+  test_buffers->symetric = allocate_distributed_buffer(size, sizeof(char));
+  test_buffers->local = allocate_local_buffer(size, sizeof(char));
+  test_buffers->signal = allocate_zeroed_buffer(sizeof(uint64_t), sizeof(uint64_t));
+  *buffers = (void *)test_buffers;
+}
+
+void free_signal_buffers(void *doomed){
+  signal_buffers_t *test_buffers = (signal_buffers_t *)doomed;
+  free_distributed_buffer(test_buffers->symetric);
+  free_distributed_buffer(test_buffers->signal);
+  free(test_buffers->local);
+  free(test_buffers);
+}
+
+void init_shmem_putmem_signal(void **buffers, index_t size){
+  init_signal_buffers(buffers, size);
+}
+
+void init_shmem_putmem_signal_nbi(void **buffers, index_t size){
+  init_signal_buffers(buffers, size);
+}
+
+void init_shmem_signal_fetch(void **buffers, index_t size){
+  init_signal_buffers(buffers, size);
+}
+
+index_t test_shmem_putmem_signal(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  if(TARGET_COUNT == 0) return 1;
+  signal_buffers_t *test_buffers = (signal_buffers_t *)buffers;
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_putmem_signal(test_buffers->symetric, test_buffers->local, test_size, test_buffers->signal, 1, SHMEM_SIGNAL_ADD, TARGET_PE(idx));
+  }
+  shmem_quiet();
+  *bytes_transfered = test_size * TARGET_COUNT;
+  return 0;
+}
+
+index_t test_shmem_putmem_signal_nbi(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  if(TARGET_COUNT == 0) return 1;
+  signal_buffers_t *test_buffers = (signal_buffers_t *)buffers;
+  for(int idx=0; idx < TARGET_COUNT; idx++){
+    shmem_putmem_signal_nbi(test_buffers->symetric, test_buffers->local, test_size, test_buffers->signal, 1, SHMEM_SIGNAL_ADD, TARGET_PE(idx));
+  }
+  shmem_quiet();
+  *bytes_transfered = test_size * TARGET_COUNT;
+  return 0;
+}
+
+/* Local read of the signal word, as a consumer polling for arrivals does */
+index_t test_shmem_signal_fetch(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  signal_buffers_t *test_buffers = (signal_buffers_t *)buffers;
+  *bytes_transfered = 0;
+  return (index_t)shmem_signal_fetch(test_buffers->signal);
+}
+
+/* Team based collectives over SHMEM_TEAM_WORLD */
+index_t test_shmem_broadcastmem(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  broadcast_buffers_t *broadcast_buffers = (broadcast_buffers_t *)buffers;
+  shmem_broadcastmem(SHMEM_TEAM_WORLD, broadcast_buffers->target, broadcast_buffers->source, test_size, 0);
+  *bytes_transfered = test_size;
+  return 0;
+}
+
+void init_shmem_alltoallmem(void **buffers, index_t size){
+  broadcast_buffers_t *broadcast_buffers = malloc(sizeof(broadcast_buffers_t));
+  broadcast_buffers->target = allocate_distributed_buffer(size * N_PES, sizeof(char));
+  broadcast_buffers->source = allocate_distributed_buffer(size * N_PES, sizeof(char));
+  broadcast_buffers->pSync = NULL;
+  *buffers = (void *)broadcast_buffers;
+}
+
+index_t test_shmem_alltoallmem(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  broadcast_buffers_t *broadcast_buffers = (broadcast_buffers_t *)buffers;
+  shmem_alltoallmem(SHMEM_TEAM_WORLD, broadcast_buffers->target, broadcast_buffers->source, test_size);
+  *bytes_transfered = test_size * REMOTE_PES;
+  return 0;
+}
+
+index_t test_shmem_team_sync(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){
+  shmem_team_sync(SHMEM_TEAM_WORLD);
+  *bytes_transfered = 0;
+  return 0;
+}
+
+#define team_reduce_type(type, name, op)\
+index_t test_shmem_ ## name ## _ ## op ## _reduce(index_t test_start, index_t test_size, void *buffers, index_t *bytes_transfered){\
+  index_t num_indexes = compute_indexes_per_pe(test_size, sizeof(type));\
+  collective_buffers_t *local_buffers = (collective_buffers_t *)buffers;\
+  shmem_ ## name ## _ ## op ## _reduce(SHMEM_TEAM_WORLD, (type *)local_buffers->target, (type *)local_buffers->source, num_indexes);\
+  *bytes_transfered = num_indexes * sizeof(type);\
+  return 0;\
+}
+
+#define team_reduce_types(reduce_function, op)\
+  reduce_function(int, int, op)\
+  reduce_function(long, long, op)\
+  reduce_function(long long, longlong, op)
+
+team_reduce_types(team_reduce_type, sum)
+team_reduce_types(team_reduce_type, prod)
+team_reduce_types(team_reduce_type, min)
+team_reduce_types(team_reduce_type, max)
+atomic_bitwise_types(team_reduce_type, and)
+atomic_bitwise_types(team_reduce_type, or)
+atomic_bitwise_types(team_reduce_type, xor)
+
+#endif
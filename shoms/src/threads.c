@@ -0,0 +1,270 @@
+/*
+   This file is part of SHOMS.
+
+   Copyright (C) 2014-2105, UT-Battelle, LLC.
+
+   This product includes software produced by UT-Battelle, LLC under Contract No.
+   DE-AC05-00OR22725 with the Department of Energy.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the New BSD 3-clause software license (LICENSE).
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   LICENSE for more details.
+
+   For more information please contact the SHOMS developers at:
+   bakermb@ornl.gov
+
+*/
+
+/*
+ * Threaded injection tests.  Every PE runs T OpenMP threads that issue
+ * non-blocking puts, gets or atomic adds to the PEs picked by --pattern,
+ * completing them with shmem_ctx_quiet() every --window operations.  Each
+ * size is swept over T = 1, 2, 4, ... --threads twice: once with a private
+ * context per thread and once with a single context shared by all threads,
+ * so the aggregate message rate shows what per-thread contexts buy.  Every
+ * point is timed THREADED_REPETITIONS times within the --time budget.
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <shoms.h>
+#include <orbtimer.h>
+
+#if defined(USE_THREADS) && SHOMS_SHMEM_AT_LEAST(1, 4)
+#include <omp.h>
+
+typedef enum {
+  THREAD_OP_PUT,
+  THREAD_OP_GET,
+  THREAD_OP_ADD,
+  THREAD_OP_COUNT
+} thread_op_t;
+
+/* Timed runs per (size, threads, context) point; the table gives the best
+   and the median aggregate rate over them */
+#define THREADED_REPETITIONS 5
+
+static char *thread_op_names[THREAD_OP_COUNT] = {"shmem_ctx_putmem_nbi", "shmem_ctx_getmem_nbi", "shmem_ctx_long_atomic_add"};
+static char *context_names[2] = {"private", "shared"};
+
+static char *thread_buffer_remote;
+static char *thread_buffer_local;
+static long *thread_counters;
+
+static long long thread_messages, thread_messages_total;
+static long long thread_ticks, thread_ticks_max;
+static long long pWork_messages[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+static long long pWork_ticks[_SHMEM_REDUCE_MIN_WRKDATA_SIZE];
+static long pSync_messages[_SHMEM_REDUCE_SYNC_SIZE];
+static long pSync_ticks[_SHMEM_REDUCE_SYNC_SIZE];
+
+static int compare_rates(const void *a, const void *b){
+  double left = *(const double *)a, right = *(const double *)b;
+  return (left > right) - (left < right);
+}
+
+/* Time ops_per_thread operations on each of nthreads threads.  The clock
+   runs from the barrier that releases the threads until the last of them
+   has quieted its context; the return is the number of messages sent. */
+static long long time_injection(thread_op_t op, index_t size, index_t ops_per_thread, int nthreads, int shared_context, ORB_tick_t *elapsed){
+  shmem_ctx_t shared_ctx = SHMEM_CTX_DEFAULT;
+  int shared_created = 0;
+  ORB_t timer_start, timer_stop;
+  ORB_tick_t current_time;
+
+  if(shared_context){
+    shared_created = (shmem_ctx_create(0, &shared_ctx) == 0);
+    if(!shared_created){
+      shared_ctx = SHMEM_CTX_DEFAULT;
+    }
+  }
+
+  #pragma omp parallel num_threads(nthreads)
+  {
+    int tid = omp_get_thread_num();
+    shmem_ctx_t ctx = shared_ctx;
+    int ctx_created = 0;
+    char *remote = thread_buffer_remote + tid * size;
+    char *local = thread_buffer_local + tid * size;
+    long *counter = thread_counters + tid;
+
+    if(!shared_context){
+      ctx_created = (shmem_ctx_create(SHMEM_CTX_PRIVATE, &ctx) == 0);
+      if(!ctx_created){
+        ctx = SHMEM_CTX_DEFAULT;
+      }
+    }
+
+    #pragma omp barrier
+    #pragma omp master
+    {
+      shmem_barrier_all();
+      ORB_read(timer_start);
+    }
+    #pragma omp barrier
+
+    for(index_t idx=0; TARGET_COUNT > 0 && idx < ops_per_thread; idx++){
+      int target = TARGET_PE((tid + idx) % TARGET_COUNT);
+      switch(op){
+        case THREAD_OP_PUT:
+          shmem_ctx_putmem_nbi(ctx, remote, local, size, target);
+          break;
+        case THREAD_OP_GET:
+          shmem_ctx_getmem_nbi(ctx, local, remote, size, target);
+          break;
+        default:
+          shmem_ctx_long_atomic_add(ctx, counter, 1, target);
+          break;
+      }
+      if((idx + 1) % global_message_window == 0){
+        shmem_ctx_quiet(ctx);
+      }
+    }
+    shmem_ctx_quiet(ctx);
+
+    #pragma omp barrier
+    #pragma omp master
+    {
+      ORB_read(timer_stop);
+    }
+
+    if(ctx_created){
+      shmem_ctx_destroy(ctx);
+    }
+  }
+
+  if(shared_created){
+    shmem_ctx_destroy(shared_ctx);
+  }
+
+  current_time = ORB_cycles_u(timer_stop, timer_start);
+  *elapsed = current_time > ORB_AVGLAT ? current_time - ORB_AVGLAT : 0;
+  return TARGET_COUNT > 0 ? (long long)nthreads * ops_per_thread : 0;
+}
+
+static void print_threaded_header(thread_op_t op, parsed_options_t *input_options){
+  if(MY_PE == 0){
+    fprintf(input_options->output_file, "\n#---------------------------------------------------\n"
+                                          "# Benchmarking %s (threaded)\n# #processes = %d\n# pattern = %s\n# window = %lu\n"
+                                          "#---------------------------------------------------\n"
+                                          "    #threads   context         #bytes       #messages    #reps    t_best[nsec]"
+                                          "   Msg_rate_best[M/sec]   Msg_rate_median[M/sec]   Bw_best[MB/sec]   Speedup\n",
+                                          thread_op_names[op], N_PES, global_pattern_label, (unsigned long)global_message_window);
+  }
+}
+
+void run_threaded_tests(iteration_data_t *iterations, index_t iterations_length, parsed_options_t *input_options){
+  int provided = SHMEM_THREAD_SINGLE;
+  index_t max_size = sizeof(long);
+  int max_threads = (int)input_options->max_threads;
+  struct timeval end_time;
+
+  omp_set_dynamic(0);
+  shmem_query_thread(&provided);
+  if(provided != SHMEM_THREAD_MULTIPLE){
+    if(MY_PE == 0) fprintf(input_options->output_file, "The OpenSHMEM library does not provide SHMEM_THREAD_MULTIPLE, skipping threaded tests\n");
+    return;
+  }
+
+  for(int idx=0; idx < _SHMEM_REDUCE_SYNC_SIZE; idx++){
+    pSync_messages[idx] = _SHMEM_SYNC_VALUE;
+    pSync_ticks[idx] = _SHMEM_SYNC_VALUE;
+  }
+
+  for(index_t idx=0; idx < iterations_length; idx++){
+    if(iterations[idx].data_size > max_size){
+      max_size = iterations[idx].data_size;
+    }
+  }
+  thread_buffer_remote = shmem_malloc(max_size * max_threads);
+  thread_counters = shmem_malloc(sizeof(long) * max_threads);
+  thread_buffer_local = malloc(max_size * max_threads);
+  if(thread_buffer_remote == NULL || thread_counters == NULL || thread_buffer_local == NULL){
+    if(MY_PE == 0) fprintf(input_options->output_file, "Unable to allocate %lu bytes per PE for %d threads, lower --maxsize\n",
+                           (unsigned long)(max_size * max_threads), max_threads);
+    shmem_global_exit(1);
+  }
+  memset(thread_buffer_local, 1, max_size * max_threads);
+  memset(thread_counters, 0, sizeof(long) * max_threads);
+
+  for(thread_op_t op=0; op < THREAD_OP_COUNT; op++){
+    print_threaded_header(op, input_options);
+    /* The atomics move one long whatever the message size list says */
+    index_t sizes = op == THREAD_OP_ADD ? 1 : iterations_length;
+    for(index_t size_index=0; size_index < sizes; size_index++){
+      index_t size = op == THREAD_OP_ADD ? sizeof(long) : iterations[size_index].data_size;
+      index_t ops_per_thread = iterations[size_index].iterations_count;
+      set_max_run_time(&end_time, input_options);
+      for(int shared_context=0; shared_context < 2; shared_context++){
+        double base_rate = 0;
+        for(int nthreads=1; ; nthreads = nthreads * 2 < max_threads ? nthreads * 2 : max_threads){
+          ORB_tick_t elapsed;
+          double rates[THREADED_REPETITIONS];
+          double best_rate = 0, best_seconds = 0, median_rate;
+          int reps;
+
+          if(input_options->warmup_run){
+            time_injection(op, size, ops_per_thread / 10, nthreads, shared_context, &elapsed);
+          }
+          for(reps=0; reps < THREADED_REPETITIONS; reps++){
+            if(check_run_time(&end_time, input_options) == 1){
+              break;
+            }
+            thread_messages = time_injection(op, size, ops_per_thread, nthreads, shared_context, &elapsed);
+            thread_ticks = elapsed;
+            shmem_longlong_sum_to_all(&thread_messages_total, &thread_messages, 1, 0, 0, N_PES, pWork_messages, pSync_messages);
+            shmem_longlong_max_to_all(&thread_ticks_max, &thread_ticks, 1, 0, 0, N_PES, pWork_ticks, pSync_ticks);
+
+            double seconds = (double)thread_ticks_max / ORB_REFFREQ;
+            rates[reps] = seconds > 0 ? thread_messages_total / seconds / 1000000 : 0;
+            if(reps == 0 || rates[reps] > best_rate){
+              best_rate = rates[reps];
+              best_seconds = seconds;
+            }
+          }
+
+          if(MY_PE == 0 && reps > 0){
+            qsort(rates, reps, sizeof(double), compare_rates);
+            median_rate = reps % 2 ? rates[reps / 2] : (rates[reps / 2 - 1] + rates[reps / 2]) / 2;
+            if(nthreads == 1){
+              base_rate = median_rate;
+            }
+            fprintf(input_options->output_file, "%12d   %-7s   %12lu   %13lld   %6d   %13.0f   %20.3f   %22.3f   %15.2f   %7.2f\n",
+                    nthreads, context_names[shared_context], (unsigned long)size, thread_messages_total, reps,
+                    best_seconds * 1000000000, best_rate, median_rate,
+                    best_rate * 1000000 * (double)size / (1024 * 1024), base_rate > 0 ? median_rate / base_rate : 0);
+            fflush(input_options->output_file);
+          }
+          if(reps < THREADED_REPETITIONS){
+            if(MY_PE == 0) fprintf(input_options->output_file, "Max iteration time exceeded, skipping\n");
+            goto next_size;
+          }
+          if(nthreads == max_threads){
+            break;
+          }
+        }
+      }
+    next_size:
+      ;
+    }
+  }
+
+  shmem_barrier_all();
+  shmem_free(thread_buffer_remote);
+  shmem_free(thread_counters);
+  free(thread_buffer_local);
+}
+
+#else
+
+void run_threaded_tests(iteration_data_t *iterations, index_t iterations_length, parsed_options_t *input_options){
+  if(MY_PE == 0) fprintf(input_options->output_file, "Threaded tests need OpenSHMEM 1.4 contexts and a build with THREADS=1, skipping\n");
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef GET_CLOCK_H
 #define GET_CLOCK_H
 
+#include <stdio.h>
+#include <stdlib.h>
+
 #if defined (__x86_64__) || defined(__i386__)
 /* Note: only x86 CPUs which have rdtsc instruction are supported. */
 typedef unsigned long long cycles_t;